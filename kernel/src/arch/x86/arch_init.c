@@ -29,6 +29,7 @@
 #include "driver/ramdisk.h"
 #include "kmalloc.h"
 #include "kprintf.h"
+#include "boot.h"
 #include <string.h>
 #include <stdint.h>
 
@@ -90,6 +91,8 @@ static void mm_init(struct multiboot_info *mbi)
      */
 
     msize = mbi->mem_upper * 1024;
+    if (frame_init((char *)MB_HIGH_MEM_START + msize) < 0)
+        panic("error initializing the memory map");
     lsize = MIN(msize, ZONE_LOW_TOP - MB_HIGH_MEM_START);
     ret = frame_zone_add((char *)MB_HIGH_MEM_START, lsize, 
                          PAGE_SIZE, ZONE_LOW);
@@ -107,11 +110,7 @@ static void mm_init(struct multiboot_info *mbi)
     kend = (char *)ALIGN_UP((uintptr_t)kmalloc(0,0), PAGE_SIZE); /* hack to get brk */
     kend = (char *)virt_to_phys(kend);
     mend = (char *)MB_HIGH_MEM_START + msize;
-    while (kend < mend)
-    {
-        frame_free(kend, 0);
-        kend += PAGE_SIZE;
-    }
+    frame_free_range(kend, mend);
 }
 
 /*
@@ -120,6 +119,8 @@ static void mm_init(struct multiboot_info *mbi)
  */
 void arch_init(struct multiboot_info *mbi)
 {
+    boot_stamp("start");
+
     /* 
      * Check for initrd.
      * To avoid corruption of the initrd content, this should be done
@@ -139,6 +140,7 @@ void arch_init(struct multiboot_info *mbi)
         memmove(addr, phys_to_virt((void *)s), size);
         ramdisk_init(addr, size); /* Initialize ramdisk device */
     }
+    boot_stamp("initrd");
 
     /* Initialize global descriptor table */
     gdt_init();
@@ -148,12 +150,15 @@ void arch_init(struct multiboot_info *mbi)
 
     /* Initialize PIC conroller */
     pic_init();
+    boot_stamp("cpu");
 
     /* Initialize the kernel memory allocator */
     mm_init(mbi);
+    boot_stamp("mm");
 
     /* Finish with paging initialization */
     paging_init();
+    boot_stamp("paging");
 
     /* Initialize keyboard */
     kbd_init();
@@ -28,8 +28,9 @@ void idle()
 {
     while (1)
     {
-        current_task->state = TASK_SLEEPING;
+        suspend(TASK_SLEEPING);
         scheduler();
+        timer_nohz_enter();
         asm volatile("sti");
         asm volatile("hlt");
         asm volatile("cli");
@@ -20,7 +20,20 @@
 #ifndef _BEEOS_ARCH_X86_MISC_H_
 #define _BEEOS_ARCH_X86_MISC_H_
 
+#include <stdint.h>
+
 #define sti() asm volatile ("sti")
 #define cli() asm volatile ("cli")
 
+/**
+ * Read the time stamp counter.
+ * Just the low 32 bits are returned, enough for short intervals.
+ */
+static inline uint32_t rdtsc(void)
+{
+    uint32_t lo, hi;
+    asm volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+    return lo;
+}
+
 #endif /* _BEEOS_ARCH_X86_MISC_H_ */
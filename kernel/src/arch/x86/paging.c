@@ -28,8 +28,12 @@
 #include "kprintf.h"
 #include "kmalloc.h"
 #include "mm/frame.h"
+#include "mm/vma.h"
+#include "mm/pcache.h"
 #include "panic.h"
 #include "proc.h"
+#include "util.h"
+#include "sys.h"
 #include <string.h>
 #include <errno.h>
 
@@ -61,17 +65,80 @@
 /* Virtual address to page table index (virt % 4M) / 4096 */
 #define TAB_INDEX(virt) (((uint32_t)(virt) & 0x3FFFFF) >> 12)
 
-/* Flush TLB */
+/*
+ * Kernel space page directory entries, the recursive mapping entries
+ * excluded. The kernel page tables are shared by all the page directories,
+ * kpage_dir holds the reference entries (see kernel_table_sync).
+ */
+#define KDIR_FIRST      DIR_INDEX(KVBASE)
+#define KDIR_END        1022
+#define KDIR_COUNT      (KDIR_END - KDIR_FIRST)
+
+/*
+ * Flush the TLB non global entries.
+ * Kernel pages are global (PTE_G), their entries survive the flush.
+ */
 #define flush_tlb() \
     asm volatile("mov eax, cr3\n\t" \
                  "mov cr3, eax\n\t" \
                   : : : "eax")
 
+/* Invalidate the TLB entry of a virtual address (global entries too) */
+#define page_invalidate(virt) \
+    asm volatile("invlpg [%0]" : : "r"(virt) : "memory")
+
+/*
+ * Kernel pages below this address are global. The recursive mapping is
+ * per process. The wild page table is a shared kernel table, but the wild
+ * page is remapped all the time (page copies) and is kept out of the
+ * global entries, thus a stale translation never survives a flush_tlb.
+ */
+#define PAGE_GLOBAL_END     PAGE_WILD
+
+/*
+ * Above this number of pages a range of user pages is invalidated with
+ * a TLB flush instead of one invlpg per page.
+ */
+#define PAGE_INVLPG_MAX     32
+
 /*
- * TODO: is this an i386 feature? Or has been introduced later?
- * asm volatile("invlpg (%0)" : : "r"(phys) : "memory")
+ * Invalidate the TLB entries of a range of pages.
  */
-#define page_invalidate(phys) flush_tlb()
+static void page_invalidate_range(uint32_t start, uint32_t end)
+{
+    uint32_t addr;
+
+    if ((end - start) / PAGE_SIZE > PAGE_INVLPG_MAX && end <= KVBASE) {
+        flush_tlb();
+        return;
+    }
+    for (addr = start; addr < end; addr += PAGE_SIZE)
+        page_invalidate(addr);
+}
+
+/*
+ * Present entries counter of a page table, kept in the table frame
+ * descriptor. Page tables always come from the memory map zones.
+ */
+static inline unsigned int *table_present(uint32_t pde)
+{
+    return &frame_desc((void *)(pde & PTE_MASK))->present;
+}
+
+/*
+ * Share with the current page directory a kernel page table allocated
+ * after its creation. Returns non zero if the table is now present.
+ */
+static int kernel_table_sync(int di)
+{
+    uint32_t *dir = (uint32_t *)PAGE_DIR_MAP;
+
+    if (di < KDIR_FIRST || di >= KDIR_END || !(kpage_dir[di] & PTE_P))
+        return 0;
+    /* Not present entries are never cached, no need to invalidate */
+    dir[di] = kpage_dir[di];
+    return 1;
+}
 
 /*
  * Maps a page virtual memory address to a physical memory address.
@@ -88,13 +155,17 @@ uint32_t page_map(void *virt, uint32_t page_phys)
     /* Check if is user space memory */
     if ((uint32_t)virt < KVBASE)
         flags |= PTE_U;
+
+    /* Within a large page */
+    if (dir[di] & PTE_PS)
+        panic("already mapped");
     
     /* 
      * Check if the page table is present.
      * Note that is not required to be identity mappable.
      * TODO: Add ZONE_ANY flag?
      */
-    if (!(dir[di] & PTE_P)) {
+    if (!(dir[di] & PTE_P) && !kernel_table_sync(di)) {
         /* page table not present */
         phys = (uint32_t)frame_alloc(0, ZONE_LOW);
         if (!phys)
@@ -102,6 +173,10 @@ uint32_t page_map(void *virt, uint32_t page_phys)
         dir[di] = phys | flags;
         /* Clean the new page table entries */
         memset(tab, 0, PAGE_SIZE);
+        *table_present(dir[di]) = 0;
+        /* New kernel tables are immediately visible to all processes */
+        if (di >= KDIR_FIRST && di < KDIR_END)
+            kpage_dir[di] = dir[di];
     }
 
     /*
@@ -118,61 +193,182 @@ uint32_t page_map(void *virt, uint32_t page_phys)
                 return (uint32_t)-ENOMEM;
         } else
             phys = page_phys;
+        /* Not present entries are never cached, no need to invalidate */
         tab[ti] = phys | flags;
-    } else if (!(tab[ti] & PTE_W)) /* read only page (cow) */
-        panic("COW not implemented yet");
-    else
+        if ((uint32_t)virt >= KVBASE && (uint32_t)virt < PAGE_GLOBAL_END)
+            tab[ti] |= PTE_G;
+        (*table_present(dir[di]))++;
+    } else
         panic("already mapped");
 
-    flush_tlb(); /* Just in case... */
+    return phys;
+}
 
+/*
+ * Release the page table of a virtual address if it has no more present
+ * entries. Returns the table frame, NULL if the table is still in use.
+ */
+static void *page_table_release(int di)
+{
+    uint32_t *dir = (uint32_t *)PAGE_DIR_MAP;
+    uint32_t *tab = (uint32_t *)(PAGE_TAB_MAP + (di * 0x1000));
+    uint32_t tab_phys;
+
+    /* Kernel tables are shared by all the processes, never released */
+    if (di >= KDIR_FIRST || *table_present(dir[di]) != 0)
+        return NULL;
+    tab_phys = PTE_MASK & dir[di];
+    dir[di] = 0;
+    /* Also drops the paging structures cached entries */
+    page_invalidate(tab);
+    return (void *)tab_phys;
+}
+
+/*
+ * Unmap a large page.
+ */
+static uint32_t page_unmap_large(void *virt, int retain)
+{
+    uint32_t *dir = (uint32_t *)PAGE_DIR_MAP;
+    uint32_t phys = dir[DIR_INDEX(virt)] & PDE_LARGE_MASK;
+
+    dir[DIR_INDEX(virt)] = 0;
+    page_invalidate(virt);
+    if (!retain)
+        frame_free((void *)phys, LARGE_PAGE_ORDER);
     return phys;
 }
 
 /*
  * Unmap a virtual memory address.
+ * A large page is unmapped as a whole.
  */
 uint32_t page_unmap(void *virt, int retain)
 {
-    int i;
     int di = DIR_INDEX(virt);
     int ti = TAB_INDEX(virt);
     uint32_t *dir = (uint32_t *)PAGE_DIR_MAP;
     uint32_t *tab = (uint32_t *)(PAGE_TAB_MAP + (di * 0x1000));
-    uint32_t tab_phys, pag_phys = -1;
+    uint32_t pag_phys = -1;
 
+    if (dir[di] & PTE_PS)
+        return page_unmap_large(virt, retain);
     if(dir[di] & PTE_P) {
         if (tab[ti] & PTE_P) {
             pag_phys = tab[ti] & PTE_MASK;
             tab[ti] = 0;
-            page_invalidate(pag_phys);
+            (*table_present(dir[di]))--;
+            page_invalidate(virt);
             if (!retain)
                 frame_free((void *)pag_phys, 0);
         }
 
-        /* Check if that was the last page in the page table */
-        for (i = 0; i < 1024; i++)
-            if (tab[i] & PTE_P)
-                break;
-        if (i == 1024) { /* If is the last page, delete the page table */
-            tab_phys = PTE_MASK & dir[di];
-            dir[di] = 0;
-            page_invalidate(tab_phys);
-            frame_free((void *)tab_phys, 0);
-        }
+        /* If was the last page, delete the page table */
+        frame_free(page_table_release(di), 0);
     }
-    flush_tlb();
     return pag_phys;
 }
 
+void page_batch_init(struct page_batch *batch)
+{
+    batch->start = (uint32_t)-1;
+    batch->end = 0;
+    batch->count = 0;
+}
+
+void page_unmap_batch(struct page_batch *batch, void *virt)
+{
+    int di = DIR_INDEX(virt);
+    int ti = TAB_INDEX(virt);
+    uint32_t *dir = (uint32_t *)PAGE_DIR_MAP;
+    uint32_t *tab = (uint32_t *)(PAGE_TAB_MAP + (di * 0x1000));
+    void *tab_frame;
+
+    if (!(dir[di] & PTE_P))
+        return;
+    if (dir[di] & PTE_PS) {
+        page_unmap_large(virt, 0);
+        return;
+    }
+    /* Room for the page and the table frames */
+    if (batch->count + 2 > PAGE_BATCH_MAX)
+        page_batch_flush(batch);
+    if (tab[ti] & PTE_P) {
+        batch->frames[batch->count++] = (void *)(tab[ti] & PTE_MASK);
+        tab[ti] = 0;
+        (*table_present(dir[di]))--;
+        batch->start = MIN(batch->start, (uint32_t)virt);
+        batch->end = MAX(batch->end, (uint32_t)virt + PAGE_SIZE);
+    }
+    tab_frame = page_table_release(di);
+    if (tab_frame)
+        batch->frames[batch->count++] = tab_frame;
+}
+
+void page_unmap_range(struct page_batch *batch, uint32_t start, uint32_t end)
+{
+    uint32_t *dir = (uint32_t *)PAGE_DIR_MAP;
+    uint32_t *tab;
+    uint32_t addr, next;
+    unsigned int *present;
+    void *tab_frame;
+    int di, ti;
+
+    for (addr = start; addr < end; addr = next) {
+        di = DIR_INDEX(addr);
+        next = MIN(ALIGN_DOWN(addr, LARGE_PAGE_SIZE) + LARGE_PAGE_SIZE, end);
+        if (!(dir[di] & PTE_P))
+            continue;
+        if (dir[di] & PTE_PS) {
+            page_unmap_large((void *)addr, 0);
+            continue;
+        }
+        tab = (uint32_t *)(PAGE_TAB_MAP + (di * 0x1000));
+        present = table_present(dir[di]);
+        /* Stop at the last present entry of the table */
+        for (ti = TAB_INDEX(addr); *present != 0 && addr < next;
+             ti++, addr += PAGE_SIZE) {
+            if (!(tab[ti] & PTE_P))
+                continue;
+            /* Room for the page and the table frames */
+            if (batch->count + 2 > PAGE_BATCH_MAX)
+                page_batch_flush(batch);
+            batch->frames[batch->count++] = (void *)(tab[ti] & PTE_MASK);
+            tab[ti] = 0;
+            (*present)--;
+            batch->start = MIN(batch->start, addr);
+            batch->end = MAX(batch->end, addr + PAGE_SIZE);
+        }
+        if (batch->count == PAGE_BATCH_MAX)
+            page_batch_flush(batch);
+        tab_frame = page_table_release(di);
+        if (tab_frame)
+            batch->frames[batch->count++] = tab_frame;
+    }
+}
+
+void page_batch_flush(struct page_batch *batch)
+{
+    if (batch->start < batch->end)
+        page_invalidate_range(batch->start, batch->end);
+    frame_free_bulk(batch->frames, batch->count);
+    page_batch_init(batch);
+}
+
 /*
  * Delete a page directory.
  */
 void page_dir_del(uint32_t phys)
 {
-    int di, ti;
+    int di, ti, n;
     uint32_t *tab;
     uint32_t *dir_curr, *dir;
+
+    /* Still in use by a vfork child or by its parent */
+    if (frame_desc((void *)phys)->refs > 1) {
+        frame_free((void *)phys, 0);
+        return;
+    }
     
     dir_curr = (uint32_t *)PAGE_DIR_MAP; 
     /* Temporary map the dir in under the current dir */
@@ -183,12 +379,19 @@ void page_dir_del(uint32_t phys)
      * Release user space
      */
     for (di = 0; di < 768; di++) {
-        if (dir[di] & PTE_P) {
+        if (dir[di] & PTE_PS) {
+            frame_free((char *)(dir[di] & PDE_LARGE_MASK), LARGE_PAGE_ORDER);
+        } else if (dir[di] & PTE_P) {
             tab = (uint32_t *)(PAGE_TAB_MAP2 + (di * 4096));
-            for (ti = 0; ti < 1024; ti++) {
+            /*
+             * The table is going away, reuse it to gather the frames
+             * addresses and release them in one shot.
+             */
+            for (ti = 0, n = 0; ti < 1024; ti++) {
                 if (tab[ti] & PTE_P)
-                    frame_free((char *)(tab[ti] & PTE_MASK), 0);
+                    tab[n++] = tab[ti] & PTE_MASK;
             }
+            frame_free_bulk((void **)tab, n);
             frame_free((char *)(dir[di] & PTE_MASK), 0);
         }
     }
@@ -201,6 +404,8 @@ void page_dir_del(uint32_t phys)
 
 /*
  * Duplicates the current process page directory.
+ * User pages are not copied, the frames are shared read only by the two
+ * directories and copied on the first write (see page_fault_handler).
  */
 uint32_t page_dir_dup(int dup_user)
 {
@@ -209,7 +414,6 @@ uint32_t page_dir_dup(int dup_user)
     uint32_t *dir_dst;
     uint32_t *tab_src;
     uint32_t *tab_dst;
-    void *mem_src, *mem_dst;
     uint32_t phys;
     int flags = PTE_W | PTE_P;
 
@@ -223,7 +427,7 @@ uint32_t page_dir_dup(int dup_user)
      * Kernel code and data
      */
 
-    memcpy(&dir_dst[768], &dir_src[768], 254*4);
+    memcpy(&dir_dst[KDIR_FIRST], &kpage_dir[KDIR_FIRST], KDIR_COUNT * 4);
     dir_dst[1023] = phys | flags;
     dir_dst[1022] = 0;
     flush_tlb();
@@ -240,63 +444,320 @@ uint32_t page_dir_dup(int dup_user)
             if (!dir_src[i])
                 continue;
 
+            if (dir_src[i] & PTE_PS) {
+                /* Large pages are shared and copied on write as well */
+                if (dir_src[i] & PTE_W)
+                    dir_src[i] = (dir_src[i] & ~PTE_W) | PTE_COW;
+                dir_dst[i] = dir_src[i];
+                frame_ref((void *)(dir_src[i] & PDE_LARGE_MASK));
+                continue;
+            }
+
             tab_src = (uint32_t *)(PAGE_TAB_MAP + (i * PAGE_SIZE));
             tab_dst = (uint32_t *)(PAGE_TAB_MAP2 + (i * PAGE_SIZE));
             phys = page_map(tab_dst, -1);
             memset(tab_dst, 0, PAGE_SIZE);
             dir_dst[i] = phys | flags;
+            *table_present(dir_dst[i]) = *table_present(dir_src[i]);
 
             for (j = 0; j < 1024; j++)
             {
-                if (!tab_src[j])
+                if (!(tab_src[j] & PTE_P))
                     continue;
 
-                /* TODO: copy on write (in the page fault handler) */
-                //tab_src[j] &= ~PTE_W; // NON SEMBRA FUNZIONARE...
-                //tab_dst[j] = tab_src[j];
-                mem_src = (void *)((i * 0x400000) + (j * 0x1000));
-                mem_dst = (void *)PAGE_WILD;
-                phys = page_map(mem_dst, -1);
-                memcpy(mem_dst, mem_src, PAGE_SIZE);
-                page_unmap(mem_dst, 1);
-                tab_dst[j] = phys | flags;
+                /* Share the frame, writable pages become copy on write */
+                if (tab_src[j] & PTE_W)
+                    tab_src[j] = (tab_src[j] & ~PTE_W) | PTE_COW;
+                tab_dst[j] = tab_src[j];
+                frame_ref((void *)(tab_src[j] & PTE_MASK));
             }
         }
     }
 
+    /* Drop the temporary mapping and the source writeable entries */
     phys = dir_src[1022] & PTE_MASK;
     dir_src[1022] = 0;
-    page_invalidate(phys);
+    flush_tlb();
     return phys;
 }
 
+void page_protect(uint32_t start, uint32_t end, int flags)
+{
+    uint32_t *dir = (uint32_t *)PAGE_DIR_MAP;
+    uint32_t *tab, *pte, addr;
+
+    for (addr = start; addr < end; addr += PAGE_SIZE) {
+        pte = &dir[DIR_INDEX(addr)];
+        if (!(*pte & PTE_P) || (*pte & PTE_PS)) {
+            /* Skip to the next page table */
+            addr = ALIGN_DOWN(addr, LARGE_PAGE_SIZE) +
+                   (LARGE_PAGE_SIZE - PAGE_SIZE);
+            if (!(*pte & PTE_P))
+                continue;
+        } else {
+            tab = (uint32_t *)(PAGE_TAB_MAP + (DIR_INDEX(addr) * 0x1000));
+            pte = &tab[TAB_INDEX(addr)];
+            if (!(*pte & PTE_P))
+                continue;
+        }
+        if (!(flags & VMA_WRITE))
+            *pte &= ~PTE_W;
+        else if (!(*pte & PTE_W))
+            *pte |= PTE_COW;
+        if (flags & (VMA_READ | VMA_WRITE | VMA_EXEC))
+            *pte |= PTE_U;
+        else
+            *pte &= ~PTE_U;
+    }
+    page_invalidate_range(start, end);
+}
+
 /*
- * Propagates a kernel virtual address mapping to all the other processes.
- * This happens for kmalloced virtual addresses that are after the initially
- * mapped kernel space (4MB).
+ * Copy on write of a large page.
+ * The copy is done through the wild page, one small page at a time.
  */
-static void map_propagate(int idx)
+static int page_cow_large(uint32_t virt)
 {
-    uint32_t *dir_src, *dir_dst;
-    struct task *other;
+    uint32_t *dir = (uint32_t *)PAGE_DIR_MAP;
+    uint32_t *pde = &dir[DIR_INDEX(virt)];
+    uint32_t *wild, phys, off, base = ALIGN_DOWN(virt, LARGE_PAGE_SIZE);
+    struct frame *frame;
 
-    other = list_container(current_task->tasks.next, 
-            struct task, tasks);
-    /*
-     * The non-current process page dir is mapped just below the
-     * current process page directory.
-     */
-    dir_src = (uint32_t *)PAGE_DIR_MAP; 
-    dir_dst = (uint32_t *)(PAGE_TAB_MAP + (1022 * 4096));
-    while (other != current_task)
-    {
-        dir_src[1022] = other->arch.pgdir | PTE_W | PTE_P;
-        dir_dst[idx] = dir_src[idx];
-        flush_tlb();
-        other = list_container(other->tasks.next, struct task, tasks);
+    if (!(*pde & PTE_COW))
+        return -1;
+
+    phys = *pde & PDE_LARGE_MASK;
+    frame = frame_desc((void *)phys);
+    if (frame && frame->refs > 1) {
+        phys = (uint32_t)frame_alloc(LARGE_PAGE_ORDER, ZONE_HIGH);
+        if (!phys)
+            return -1;
+        if ((int)page_map((void *)PAGE_WILD, phys) < 0) {
+            frame_free((void *)phys, LARGE_PAGE_ORDER);
+            return -1;
+        }
+        wild = (uint32_t *)(PAGE_TAB_MAP + (DIR_INDEX(PAGE_WILD) * 0x1000));
+        wild = &wild[TAB_INDEX(PAGE_WILD)];
+        for (off = 0; off < LARGE_PAGE_SIZE; off += PAGE_SIZE) {
+            *wild = (phys + off) | PTE_W | PTE_P;
+            page_invalidate(PAGE_WILD);
+            memcpy((void *)PAGE_WILD, (void *)(base + off), PAGE_SIZE);
+        }
+        page_unmap((void *)PAGE_WILD, 1);
+        frame_free((void *)(*pde & PDE_LARGE_MASK), LARGE_PAGE_ORDER);
     }
-    dir_src[1022] = 0;
-    flush_tlb();
+    *pde = (*pde & ~(PDE_LARGE_MASK | PTE_COW)) | phys | PTE_W;
+    page_invalidate(base);
+    return 0;
+}
+
+/*
+ * Resolve a write fault on a copy on write page.
+ * The faulting process gets its own copy of the page, or just the write
+ * permission back if there are no other users of the frame.
+ */
+static int page_cow(uint32_t virt)
+{
+    uint32_t *dir = (uint32_t *)PAGE_DIR_MAP;
+    uint32_t *tab = (uint32_t *)(PAGE_TAB_MAP + (DIR_INDEX(virt) * 0x1000));
+    uint32_t *pte = &tab[TAB_INDEX(virt)];
+    uint32_t phys, page = ALIGN_DOWN(virt, PAGE_SIZE);
+    struct frame *frame;
+
+    if (dir[DIR_INDEX(virt)] & PTE_PS)
+        return page_cow_large(virt);
+    if (!(dir[DIR_INDEX(virt)] & PTE_P) || !(*pte & PTE_COW))
+        return -1;
+
+    phys = *pte & PTE_MASK;
+    frame = frame_desc((void *)phys);
+    if (frame && frame->refs > 1) {
+        /* Still shared, copy it */
+        phys = (uint32_t)frame_alloc(0, ZONE_HIGH);
+        if (!phys)
+            return -1;
+        if ((int)page_map((void *)PAGE_WILD, phys) < 0) {
+            frame_free((void *)phys, 0);
+            return -1;
+        }
+        memcpy((void *)PAGE_WILD, (void *)page, PAGE_SIZE);
+        page_unmap((void *)PAGE_WILD, 1);
+        /* Drop the reference to the shared frame */
+        frame_free((void *)(*pte & PTE_MASK), 0);
+    }
+    *pte = (*pte & ~(PTE_MASK | PTE_COW)) | phys | PTE_W;
+    page_invalidate(page);
+    return 0;
+}
+
+/*
+ * Check if a virtual address is mapped.
+ */
+static int page_present(uint32_t virt)
+{
+    uint32_t *dir = (uint32_t *)PAGE_DIR_MAP;
+    uint32_t *tab = (uint32_t *)(PAGE_TAB_MAP + (DIR_INDEX(virt) * 0x1000));
+
+    return (dir[DIR_INDEX(virt)] & PTE_P) &&
+           ((dir[DIR_INDEX(virt)] & PTE_PS) || (tab[TAB_INDEX(virt)] & PTE_P));
+}
+
+/*
+ * Map a zero filled large page for a large pages area.
+ * Fails if the page table is already in use for small pages or if there
+ * are no free large frames, then small pages are used.
+ */
+static int page_populate_large(struct vma *vma, uint32_t virt)
+{
+    uint32_t *dir = (uint32_t *)PAGE_DIR_MAP;
+    uint32_t phys, base = ALIGN_DOWN(virt, LARGE_PAGE_SIZE);
+
+    if ((dir[DIR_INDEX(virt)] & PTE_P) || base < vma->start ||
+        base + LARGE_PAGE_SIZE > vma->end)
+        return -1;
+    phys = (uint32_t)frame_alloc(LARGE_PAGE_ORDER, ZONE_HIGH);
+    if (!phys)
+        return -1;
+    /* Not present entries are never cached, no need to invalidate */
+    dir[DIR_INDEX(virt)] = phys | PTE_PS | PTE_U | PTE_W | PTE_P;
+    memset((void *)base, 0, LARGE_PAGE_SIZE);
+    if (!(vma->flags & VMA_WRITE)) {
+        dir[DIR_INDEX(virt)] &= ~PTE_W;
+        page_invalidate(base);
+    }
+    return 0;
+}
+
+/*
+ * Physical address of a mapped page.
+ */
+static uint32_t page_phys(uint32_t virt)
+{
+    uint32_t *tab = (uint32_t *)(PAGE_TAB_MAP + (DIR_INDEX(virt) * 0x1000));
+
+    return tab[TAB_INDEX(virt)] & PTE_MASK;
+}
+
+/*
+ * Read the content of a run of new pages.
+ * The whole file pages of a shared area are added to the page cache.
+ */
+static int page_fill(struct vma *vma, uint32_t start, uint32_t end,
+        int shared)
+{
+    uint32_t addr;
+
+    if (vma_fill(vma, start, end - start) < 0)
+        return -1;
+    for (addr = start; shared && addr < end; addr += PAGE_SIZE) {
+        if (addr + PAGE_SIZE > vma->fend)
+            break;
+        pcache_insert(vma->inode, vma->offset + (addr - vma->start),
+                (void *)page_phys(addr));
+    }
+    return 0;
+}
+
+/*
+ * Map and populate the missing pages around a faulting page.
+ * For file backed areas the run of missing pages containing the faulting
+ * one, within the fault around window, is read from the file at once.
+ * The pages of read only file backed areas (e.g. the program text) are
+ * shared read only with all the processes mapping the same file, only the
+ * pages not found in the page cache are read.
+ */
+static int page_populate(struct vma *vma, uint32_t page)
+{
+    uint32_t start, end, lo, hi, addr, miss, phys;
+    uint32_t *tab;
+    int shared;
+
+    start = page;
+    end = page + PAGE_SIZE;
+    shared = 0;
+    if (vma->inode) {
+        lo = ALIGN_DOWN(page, VMA_FAULT_AROUND * PAGE_SIZE);
+        hi = MIN(lo + VMA_FAULT_AROUND * PAGE_SIZE, vma->end);
+        lo = MAX(lo, vma->start);
+        while (start > lo && !page_present(start - PAGE_SIZE))
+            start -= PAGE_SIZE;
+        while (end < hi && !page_present(end))
+            end += PAGE_SIZE;
+        shared = !(vma->flags & VMA_WRITE);
+    }
+
+    /* Missing pages run start, 'end' if none */
+    miss = end;
+    for (addr = start; addr < end; addr += PAGE_SIZE) {
+        phys = 0;
+        if (shared)
+            phys = (uint32_t)pcache_lookup(vma->inode,
+                    vma->offset + (addr - vma->start));
+        if (phys == 0) {
+            if ((int)page_map((char *)addr, (uint32_t)-1) < 0)
+                goto bad;
+            if (miss == end)
+                miss = addr;
+            continue;
+        }
+        if (miss != end) {
+            if (page_fill(vma, miss, addr, shared) < 0)
+                goto bad;
+            miss = end;
+        }
+        if ((int)page_map((char *)addr, phys) < 0)
+            goto bad;
+        frame_ref((void *)phys);
+    }
+    if (miss != end && page_fill(vma, miss, end, shared) < 0)
+        goto bad;
+
+    if (shared) {
+        for (addr = start; addr < end; addr += PAGE_SIZE) {
+            tab = (uint32_t *)(PAGE_TAB_MAP + (DIR_INDEX(addr) * 0x1000));
+            tab[TAB_INDEX(addr)] &= ~PTE_W;
+        }
+        page_invalidate_range(start, end);
+    }
+    return 0;
+
+bad:
+    while (addr > start) {
+        addr -= PAGE_SIZE;
+        page_unmap((char *)addr, 0);
+    }
+    return -1;
+}
+
+/*
+ * Resolve a user space page fault.
+ * Missing pages are allocated only within the process memory areas and
+ * populated with the area content (file data or zeros). The stack area is
+ * expanded if the address is just below it.
+ * Write faults on copy on write pages are resolved by page_cow.
+ */
+static int page_fault_user(uint32_t virt, uint32_t err)
+{
+    struct vma *vma;
+    uint32_t page = ALIGN_DOWN(virt, PAGE_SIZE);
+
+    vma = vma_find(&current_task->vmas, virt);
+    if (!vma)
+        vma = vma_stack_expand(&current_task->vmas, page);
+    if (!vma || ((err & PFE_W) && !(vma->flags & VMA_WRITE)) ||
+        !(vma->flags & (VMA_READ | VMA_WRITE | VMA_EXEC)))
+        return -1;
+
+    if (err & PFE_P) {
+        if (!(err & PFE_W) || page_cow(virt) < 0)
+            return -1;
+    } else if ((!(vma->flags & VMA_LARGE) ||
+                page_populate_large(vma, virt) < 0) &&
+               page_populate(vma, page) < 0) {
+        return -1;
+    }
+    current_task->faults++;
+    return 0;
 }
 
 /*
@@ -304,22 +765,24 @@ static void map_propagate(int idx)
  * Here, after some conditions checking, we try to resolve the fault
  * mapping a physical frame into the missing page.
  *
- * Mapping of kernel space pages are propagated in all the system
- * processes. This often happens during kernel heap expansion that
- * overflows in unmapped memory. Kernel heap must be consistent for
- * all the processes within the system.
+ * Kernel page tables are shared by all the processes, thus kernel space
+ * mappings never need to be propagated. A page directory created before
+ * a kernel table allocation gets the table on the first access.
  *
  * If the fault happens in user space (vaddr < KBASE) then we check that
- * the involved process have the rights to access to the required address.
- * If not we send a SEGV signal to the current process (TODO).
- * rdreference
+ * the address is within one of the process memory areas (see
+ * page_fault_user). If not we send a SEGV signal to the current process.
+ * A kernel access on behalf of the process (e.g. a syscall buffer) can't
+ * be aborted, and completing it would require memory the process doesn't
+ * own. The syscalls check their buffers in advance (see vma_access), if
+ * an unchecked access faults the process is terminated at once.
  */
 static void page_fault_handler(void)
 {
-    uint32_t virt, phys;
-    int flags = ZONE_LOW;
+    uint32_t virt, err;
 
     asm volatile ("mov %0, cr2" : "=r"(virt));
+    err = current_task->arch.ifr->err_no;
 
 #if DEBUG
     kprintf("pid: %d\n", current_task->pid);
@@ -329,60 +792,68 @@ static void page_fault_handler(void)
 #endif
 
     if (virt < KVBASE) {
-        /*
-         * TODO: just in 2 particular cases, else send to the process SIGSEGV
-         * 1) Can expand stack
-         * 2) Can expand heap
-         */
-        flags = ZONE_HIGH;
+        if (page_fault_user(virt, err) == 0)
+            return;
+        if ((err & PFE_U) == 0) {
+            kprintf("[warn] pid %d: bad user access at 0x%x\n",
+                    current_task->pid, virt);
+            sys_exit(1);
+        }
+        sys_kill(current_task->pid, SIGSEGV);
+        return;
     }
 
-    phys = (uint32_t)frame_alloc(0, flags);
-    if (!phys)
-        panic("Out of mem in page fault handler");
+    if (err & PFE_U) {
+        sys_kill(current_task->pid, SIGSEGV);
+        return;
+    }
+
+    if (kernel_table_sync(DIR_INDEX(virt)) && page_present(virt))
+        return;
+    /* The frame comes from the high memory zone by default (page_map). */
     if ((int)page_map((char *)virt, (uint32_t)-1) < 0)
         panic("Map page error");
-    
-    if (virt >= KVBASE) {
-        map_propagate(DIR_INDEX(virt)); 
-        kprintf("Propagate\n");
-    }
 }
 
 /*
- * Initialize paging subsystem.
+ * Check the global pages support (P6 and later).
  */
-void paging_init(void)
+static int cpu_has_pge(void)
 {
-    int i;
-    uint32_t *tab, phys;
+    uint32_t eax = 1, ebx, ecx, edx;
 
-    /* 
-     * New page table physical address.
-     * For the first process we preserve the page dir already in use.
-     */
-    phys = (uint32_t)frame_alloc(0, 0);
+    asm volatile("cpuid" : "+a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx));
+    return (edx & (1 << 13)) != 0;
+}
 
+/*
+ * Initialize paging subsystem.
+ */
+void paging_init(void)
+{
     /* Recursive page mapping trick */
     kpage_dir[1023] = (uint32_t)virt_to_phys(kpage_dir) | PTE_W | PTE_P;
 
-    /* Temporary mapping to construct the page table */
-    kpage_dir[0] = phys | PTE_W | PTE_P;
-    flush_tlb();
-   
-    tab = (uint32_t *)PAGE_TAB_MAP; /* Page table for virtual address 0x0 */
-    for (i = 0; i < 1024; i++)      /* Identity map the first 4 MB */
-        tab[i] = (i * PAGE_SIZE) | PTE_W | PTE_P;
-
-    /* 
-     * Now the new kernel page table is ready to be used in place of the
-     * current page dir entry. Note that this operation MUST be done after
-     * the table construction (is flush strictly needed???)
+    /*
+     * The first 4 MB, holding the kernel image and the low memory zone
+     * (thus all the kernel heap), are linearly mapped by the large page
+     * already used by the startup code. This takes a single TLB entry.
      */
-    kpage_dir[768] = kpage_dir[0];
+    kpage_dir[768] = 0 | PTE_PS | PTE_G | PTE_W | PTE_P;
     kpage_dir[0] = 0; /* Unmap the low 4MB */
     flush_tlb();
 
+    /*
+     * Kernel pages are global, their TLB entries are not flushed on
+     * process switch. Setting PGE flushes all the entries.
+     */
+    if (cpu_has_pge()) {
+        asm volatile("mov eax, cr4\n\t"
+                     "or  eax, %0\n\t"
+                     "mov cr4, eax\n\t"
+                     : : "i"(CR4_PGE) : "eax");
+    }
+
     /* Register the page fault handler */
     isr_register_handler(ISR_PAGE_FAULT, page_fault_handler);
 }
@@ -41,6 +41,7 @@ uint32_t page_dir_dup(int dup_user);
 
 /**
  * Deletes a page directory.
+ * A directory shared by a vfork child is only released by the last user.
  *
  * @param pgdir Physical address of the dir to delete.
  */
@@ -67,6 +68,72 @@ uint32_t page_map(void *virt, uint32_t phys);
  */
 uint32_t page_unmap(void *virt, int retain);
 
+/** Maximum number of frames released at once by an unmap batch. */
+#define PAGE_BATCH_MAX  32
+
+/**
+ * Unmap batch.
+ * Range operations unmap the pages through a batch, then the TLB entries
+ * are invalidated at once and only afterwards the frames are released.
+ */
+struct page_batch
+{
+    uint32_t        start;  /**< Lowest unmapped address */
+    uint32_t        end;    /**< End of the highest unmapped page */
+    unsigned int    count;  /**< Number of frames to release */
+    void            *frames[PAGE_BATCH_MAX]; /**< Frames to release */
+};
+
+/**
+ * Initialize an unmap batch.
+ *
+ * @param batch     Unmap batch.
+ */
+void page_batch_init(struct page_batch *batch);
+
+/**
+ * Unmap a virtual memory address, deferring the TLB invalidation and the
+ * release of the frames to the batch flush.
+ * The batch is flushed in advance if full.
+ *
+ * @param batch     Unmap batch.
+ * @param virt      Page virtual memory address.
+ */
+void page_unmap_batch(struct page_batch *batch, void *virt);
+
+/**
+ * Unmap all the pages of a virtual address range through a batch.
+ * Each page table is visited once and the scan stops as soon as the
+ * table has no more present entries. Empty page tables are released and
+ * large pages are unmapped as a whole.
+ *
+ * @param batch     Unmap batch.
+ * @param start     Range start address (page aligned).
+ * @param end       Range end address (page aligned).
+ */
+void page_unmap_range(struct page_batch *batch, uint32_t start,
+                      uint32_t end);
+
+/**
+ * Invalidate the TLB entries of the pages unmapped by a batch and release
+ * their frames. The batch is ready to be reused.
+ *
+ * @param batch     Unmap batch.
+ */
+void page_batch_flush(struct page_batch *batch);
+
+/**
+ * Set the protection of the mapped user pages of an address range.
+ * Pages that become writeable are made copy on write, thus frames shared
+ * with other processes or with the page cache are copied on write.
+ *
+ * @param start     Range start address (page aligned).
+ * @param end       Range end address (page aligned).
+ * @param flags     Memory area access flags (e.g. VMA_WRITE). Without
+ *                  any access flag the pages are reserved to the kernel.
+ */
+void page_protect(uint32_t start, uint32_t end, int flags);
+
 /**
  * Switch current page directory.
  *
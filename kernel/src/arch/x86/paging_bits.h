@@ -29,6 +29,12 @@
  */
 #define PAGE_SIZE       0x1000
 
+/*
+ * Large (PSE) page size and frames allocation order
+ */
+#define LARGE_PAGE_SIZE     0x400000
+#define LARGE_PAGE_ORDER    10
+
 /*
  * Control Register flags
  */
@@ -44,6 +50,7 @@
 #define CR0_CD          0x40000000      /* Cache Disable */
 #define CR0_PG          0x80000000      /* Paging */
 #define CR4_PSE         0x00000010      /* Page size extension */
+#define CR4_PGE         0x00000080      /* Page global enable */
 
 /*
  * Page table/directory entry flags
@@ -52,6 +59,16 @@
 #define PTE_W           0x00000002      /* Writeable */
 #define PTE_U           0x00000004      /* User */
 #define PTE_PS          0x00000080      /* Page size, if set 4MB else 4KB */
+#define PTE_G           0x00000100      /* Global, not flushed on CR3 load */
+#define PTE_COW         0x00000200      /* Copy on write (available bit) */
 #define PTE_MASK        0xFFFFF000      /* Page pysical address mask */
+#define PDE_LARGE_MASK  0xFFC00000      /* Large page physical address mask */
+
+/*
+ * Page fault error code flags
+ */
+#define PFE_P           0x00000001      /* Protection fault, else not present */
+#define PFE_W           0x00000002      /* Write access, else read */
+#define PFE_U           0x00000004      /* User mode access */
 
 #endif /* _BEEOS_ARCH_X86_PAGING_BITS_H_ */
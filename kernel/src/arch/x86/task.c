@@ -20,7 +20,8 @@
 #include "proc.h"
 #include "arch/x86/task.h"
 #include "paging.h"
-#include "kmalloc.h"
+#include "mm/slab.h"
+#include "mm/frame.h"
 #include <stddef.h>
 
 extern uint32_t get_eip();
@@ -28,10 +29,23 @@ extern uint32_t get_eip();
 extern struct task ktask;
 extern struct task *current_task;
 
+/*
+ * Kernel stacks cache.
+ * Stacks must be KSTACK_SIZE aligned, the stack base is recovered by
+ * aligning down the stack pointer.
+ */
+static struct slab_cache kstack_cache;
+
+void task_arch_cache_init(void)
+{
+    slab_cache_init(&kstack_cache, "kstack-cache", KSTACK_SIZE,
+            KSTACK_SIZE, 0, NULL, NULL);
+}
+
 /*
  * TODO : implement as clone syscall
  */
-int task_arch_init(struct task_arch *task)
+int task_arch_init(struct task_arch *task, int flags)
 {
     char *ti;
     extern uint32_t fork_ret;
@@ -43,14 +57,20 @@ int task_arch_init(struct task_arch *task)
         return 0;
     }
 
-    task->pgdir = page_dir_dup(1);
+    if (flags & TASK_VFORK) {
+        /* Borrowed, the last page_dir_del releases the directory */
+        task->pgdir = current_task->arch.pgdir;
+        frame_ref((void *)task->pgdir);
+    } else {
+        task->pgdir = page_dir_dup(!(flags & TASK_SPAWN));
+    }
     if ((int)task->pgdir < 0)
         return (int)task->pgdir; /* Fail */
 
     task->ifr = NULL;
     task->sfr = NULL;
 
-    ti = kmalloc(KSTACK_SIZE, 0);
+    ti = slab_cache_alloc(&kstack_cache, 0);
     if (ti == NULL)
         return -1;
 
@@ -70,9 +90,24 @@ int task_arch_init(struct task_arch *task)
     return 0;
 }
 
+void task_arch_entry(struct task_arch *task, void (*func)(void *),
+        void *arg)
+{
+    extern uint32_t entry_ret;
+    uint32_t *sp = (uint32_t *)task->esp;
+
+    /* The stack top holds the parent frame copy */
+    task->ifr = (struct isr_frame *)sp;
+    *--sp = (uint32_t)arg;
+    *--sp = (uint32_t)&entry_ret; /* Return address of func */
+    task->esp = (uint32_t)sp;
+    task->eip = (uint32_t)func;
+}
+
 void task_arch_deinit(struct task_arch *task)
 {
-    kfree((void *)ALIGN_DOWN(task->esp, KSTACK_SIZE), KSTACK_SIZE);
+    slab_cache_free(&kstack_cache,
+            (void *)ALIGN_DOWN(task->esp, KSTACK_SIZE));
     page_dir_del(task->pgdir);
 }
 
@@ -94,14 +129,16 @@ void task_arch_switch(struct task_arch *curr, struct task_arch *next)
 
     tss.esp0 = ALIGN_UP(next->esp, KSTACK_SIZE);
 
+    /* Kernel pages are global, only the user TLB entries are flushed */
+    if (next->pgdir != curr->pgdir)
+        page_dir_switch(next->pgdir);
+
     asm volatile("mov    esp, %0 \n\t"
                  "mov    ebp, %1 \n\t"
-                 "mov    cr3, %2 \n\t"
-                 "jmp    %3      \n\t"
+                 "jmp    %2      \n\t"
                  "switch_end:    \n\t"
               : : "r"(next->esp), 
                   "r"(next->ebp), 
-                  "r"(next->pgdir),
                   "r"(next->eip));
 }
 
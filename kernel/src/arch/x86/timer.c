@@ -28,16 +28,98 @@
 
 #define TIMER_FREQ          1193180 /* Timer built-in frequency */
 #define TIMER_OPMODE        0x04    /* Mode 2, rate generator */
+#define TIMER_ONESHOT       0x00    /* Mode 0, interrupt on terminal count */
 #define TIMER_ACCESS        0x30    /* 16bit, LSB first */
+#define TIMER_READBACK      0xC2    /* Latch counter 0 status and count */
+#define TIMER_STATUS_OUT    0x80    /* Output pin, high once expired */
+#define TIMER_COUNT_MAX     0xFFFF
 
-extern unsigned long timer_ticks;
+/* Counts per tick */
+static uint32_t divisor;
+
+/* Ticks to the programmed one-shot interrupt, zero in periodic mode */
+static unsigned long oneshot;
+
+static void timer_program(uint8_t mode, uint32_t count)
+{
+    outb(TIMER_IO_CMD, mode | TIMER_ACCESS);
+    /* The count is sent byte-wise, low byte first */
+    outb(TIMER_IO_DAT, (uint8_t)count);
+    outb(TIMER_IO_DAT, (uint8_t)(count >> 8));
+}
+
+/* Latch and read the counter, returns the output pin status */
+static int timer_read(uint32_t *count)
+{
+    uint8_t status, lo, hi;
+
+    outb(TIMER_IO_CMD, TIMER_READBACK);
+    status = inb(TIMER_IO_DAT);
+    lo = inb(TIMER_IO_DAT);
+    hi = inb(TIMER_IO_DAT);
+    *count = lo | ((uint32_t)hi << 8);
+    return (status & TIMER_STATUS_OUT) != 0;
+}
 
 static void timer_handler(void)
 {
-    timer_ticks++;
     timer_update();
 }
 
+unsigned long timer_arch_ticks(void)
+{
+    unsigned long ticks;
+    uint32_t count;
+
+    if (oneshot == 0)
+        return 1;
+    if (!timer_read(&count))
+        return 1;   /* Periodic tick raised before the one-shot start */
+    ticks = oneshot;
+    oneshot = 0;
+    timer_program(TIMER_OPMODE, divisor);
+    return ticks;
+}
+
+unsigned long timer_arch_oneshot(unsigned long ticks)
+{
+    unsigned long max;
+    uint32_t count;
+
+    if (oneshot != 0)
+        return 0;
+    /* Counts left to the next tick boundary, the interrupt stays aligned */
+    timer_read(&count);
+    if (count == 0 || count > divisor)
+        count = divisor;
+    max = (TIMER_COUNT_MAX - count) / divisor + 1;
+    if (ticks > max)
+        ticks = max;
+    if (ticks < 2)
+        return 0;
+    timer_program(TIMER_ONESHOT, count + (ticks - 1) * divisor);
+    oneshot = ticks;
+    return ticks;
+}
+
+unsigned long timer_arch_oneshot_stop(void)
+{
+    unsigned long left, elapsed;
+    uint32_t count;
+
+    if (oneshot <= 1)
+        return 0;   /* Nothing to account before the next boundary */
+    if (timer_read(&count) || count == 0)
+        return 0;   /* Expired, the pending interrupt does the accounting */
+    /* Tick boundaries still to come, the last one is the interrupt */
+    left = (count + divisor - 1) / divisor;
+    if (left > 1)
+        timer_program(TIMER_ONESHOT, count - (left - 1) * divisor);
+    elapsed = oneshot - left;
+    oneshot = 1;
+    return elapsed;
+}
+
 void timer_arch_init(unsigned int frequency)
 {
 	/* The value we send to the PIT is the value to divide it's input
@@ -46,17 +128,8 @@ void timer_arch_init(unsigned int frequency)
 	 *
 	 * TIMER_FREQ/freq < 65536 => frequency > 18,20
 	 */
-	uint32_t divisor =  TIMER_FREQ/frequency;
-
-	outb(TIMER_IO_CMD, TIMER_OPMODE | TIMER_ACCESS);
-
-	/* Divisor has to be sent byte-wise, so split here into upper/lower bytes.*/
-	uint8_t lo = (uint8_t) divisor;
-	uint8_t hi = (uint8_t) (divisor >> 8 );
-
-	/* Send the frequency divisor. */
-	outb(TIMER_IO_DAT, lo);
-	outb(TIMER_IO_DAT, hi);
+	divisor = TIMER_FREQ/frequency;
+	timer_program(TIMER_OPMODE, divisor);
 
     /* register the timer callback */
     isr_register_handler(ISR_TIMER, timer_handler);
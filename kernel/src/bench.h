@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * In-kernel micro benchmarks.
+ * Executed before the init process start if the kernel is built
+ * with the BENCH make variable defined (e.g. make BENCH=1).
+ */
+
+#ifndef _BEEOS_BENCH_H_
+#define _BEEOS_BENCH_H_
+
+#include "arch/x86/misc.h"  /* rdtsc */
+
+/**
+ * Slab allocator stress benchmark.
+ * Measures the alloc and free latency of large objects caches and the
+ * cost of walking objects spread across slabs with and without colouring.
+ */
+void bench_slab(void);
+
+/**
+ * Frame allocator benchmark.
+ * Compares the per frame cost of a fork sized batch of order zero frames
+ * allocated one at a time and in bulk.
+ */
+void bench_frame(void);
+
+/**
+ * Run all the kernel benchmarks.
+ */
+void bench_run(void);
+
+#endif /* _BEEOS_BENCH_H_ */
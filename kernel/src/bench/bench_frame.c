@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "bench.h"
+#include "mm/frame.h"
+#include "kmalloc.h"
+#include "kprintf.h"
+
+#define BENCH_FRAME_COUNT   256     /* Frames per run, a fork sized batch */
+#define BENCH_FRAME_LOOPS   16      /* Runs per allocation mode */
+
+/*
+ * Allocate BENCH_FRAME_COUNT high memory frames, one at a time or in bulk,
+ * and release them. Returns the average allocation cycles per frame.
+ */
+static uint32_t bench_frame_alloc(void **frames, int bulk)
+{
+    unsigned int i, j, n;
+    uint32_t t, tot = 0, count = 0;
+
+    for (j = 0; j < BENCH_FRAME_LOOPS; j++)
+    {
+        t = rdtsc();
+        if (bulk)
+            n = frame_alloc_bulk(BENCH_FRAME_COUNT, ZONE_HIGH, frames);
+        else
+        {
+            for (n = 0; n < BENCH_FRAME_COUNT; n++)
+                if ((frames[n] = frame_alloc(0, ZONE_HIGH)) == NULL)
+                    break;
+        }
+        tot += rdtsc() - t;
+        count += n;
+        for (i = 0; i < n; i++)
+            frame_free(frames[i], 0);
+    }
+    return (count != 0) ? tot / count : 0;
+}
+
+void bench_frame(void)
+{
+    void **frames;
+    uint32_t single, bulk;
+
+    frames = kmalloc(BENCH_FRAME_COUNT * sizeof(void *), 0);
+    if (!frames)
+        return;
+    single = bench_frame_alloc(frames, 0);
+    bulk = bench_frame_alloc(frames, 1);
+    kprintf("frame alloc %u: single=%u, bulk=%u cycles/frame\n",
+            BENCH_FRAME_COUNT, single, bulk);
+    kfree(frames, BENCH_FRAME_COUNT * sizeof(void *));
+}
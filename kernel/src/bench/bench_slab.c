@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "bench.h"
+#include "mm/slab.h"
+#include "kmalloc.h"
+#include "kprintf.h"
+#include "util.h"
+
+#define BENCH_SLAB_OBJS     20000       /* Max objects per run */
+#define BENCH_SLAB_MEM      (2 << 20)   /* Max memory per run */
+#define BENCH_SLAB_STRIDE   7919        /* Prime free order stride */
+
+#define BENCH_COLOUR_SIZE   384         /* Object size, 4 colours per slab */
+#define BENCH_COLOUR_SLABS  32          /* Slabs walked */
+#define BENCH_COLOUR_LOOPS  64          /* Walks over the objects */
+
+#define BENCH_MAG_SIZE      256         /* Object size */
+#define BENCH_MAG_BATCH     8           /* Objects per alloc/free burst */
+#define BENCH_MAG_LOOPS     2000        /* Alloc/free bursts */
+
+static void bench_slab_size(size_t size)
+{
+    struct slab_cache *cache;
+    void **objs;
+    unsigned int i, j, n, stride;
+    uint32_t t, dt, alloc_tot = 0, free_tot = 0, free_max = 0;
+    size_t hsize;
+
+    n = MIN(BENCH_SLAB_OBJS, BENCH_SLAB_MEM / size);
+    objs = kmalloc(n * sizeof(void *), 0);
+    if (!objs)
+        return;
+    cache = slab_cache_create("bench", size, 0, 0, NULL, NULL);
+    if (!cache)
+    {
+        kfree(objs, n * sizeof(void *));
+        return;
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        t = rdtsc();
+        objs[i] = slab_cache_alloc(cache, 0);
+        alloc_tot += rdtsc() - t;
+        if (!objs[i])
+            break;
+    }
+    hsize = cache->hsize;
+
+    /* Release in a scattered order to defeat any LIFO locality */
+    stride = (i % BENCH_SLAB_STRIDE) ? BENCH_SLAB_STRIDE : 1;
+    for (j = 0, n = 0; n < i; n++, j = (j + stride) % i)
+    {
+        t = rdtsc();
+        slab_cache_free(cache, objs[j]);
+        dt = rdtsc() - t;
+        free_tot += dt;
+        if (free_max < dt)
+            free_max = dt;
+    }
+
+    if (n != 0)
+        kprintf("slab %u: objs=%u, hash=%u, alloc=%u, "
+                "free=%u (max %u) cycles, alloc hit/miss=%u/%u, "
+                "free hit/miss=%u/%u\n", size, n, hsize,
+                alloc_tot / n, free_tot / n, free_max,
+                cache->alloc_hits, cache->alloc_misses,
+                cache->free_hits, cache->free_misses);
+
+    slab_cache_delete(cache);
+    kfree(objs, MIN(BENCH_SLAB_OBJS, BENCH_SLAB_MEM / size) * sizeof(void *));
+}
+
+/*
+ * Walk the first word of the objects allocated from a number of slabs.
+ * Without colouring the objects with the same index in different slabs
+ * map to the same cache sets, and the walk thrashes a few sets while the
+ * rest of the cache is unused.
+ */
+static uint32_t bench_slab_walk(unsigned int flags)
+{
+    struct slab_cache *cache;
+    void **objs;
+    unsigned int i, j, n;
+    volatile uint32_t *word;
+    uint32_t t, tot = 0;
+
+    cache = slab_cache_create("bench", BENCH_COLOUR_SIZE, 0, flags,
+            NULL, NULL);
+    if (!cache)
+        return 0;
+    n = cache->slab_objs * BENCH_COLOUR_SLABS;
+    objs = kmalloc(n * sizeof(void *), 0);
+    if (!objs)
+    {
+        slab_cache_delete(cache);
+        return 0;
+    }
+
+    for (i = 0; i < n; i++)
+        if ((objs[i] = slab_cache_alloc(cache, 0)) == NULL)
+            break;
+    n = i;
+
+    for (j = 0; j < BENCH_COLOUR_LOOPS; j++)
+    {
+        t = rdtsc();
+        for (i = 0; i < n; i++)
+        {
+            word = (volatile uint32_t *)objs[i];
+            *word += 1;
+        }
+        /* The first walk only warms up the cache */
+        if (j != 0)
+            tot += rdtsc() - t;
+    }
+
+    for (i = 0; i < n; i++)
+        slab_cache_free(cache, objs[i]);
+    kfree(objs, cache->slab_objs * BENCH_COLOUR_SLABS * sizeof(void *));
+    slab_cache_delete(cache);
+
+    return (n != 0) ? tot / ((BENCH_COLOUR_LOOPS - 1) * n) : 0;
+}
+
+static void bench_slab_colour(void)
+{
+    uint32_t plain, coloured;
+
+    plain = bench_slab_walk(SLAB_NO_COLOUR);
+    coloured = bench_slab_walk(0);
+    kprintf("slab colour %u: walk %u slabs, plain=%u, coloured=%u "
+            "cycles/obj\n", BENCH_COLOUR_SIZE, BENCH_COLOUR_SLABS,
+            plain, coloured);
+}
+
+/*
+ * Allocate and release short bursts of objects, the typical pattern of
+ * the hot kernel objects. With the magazine layer the bursts should be
+ * served by the loaded magazines without reaching the slabs.
+ */
+static void bench_slab_churn(const char *name, unsigned int flags)
+{
+    struct slab_cache *cache;
+    void *objs[BENCH_MAG_BATCH];
+    unsigned int i, j;
+    uint32_t t;
+
+    cache = slab_cache_create("bench", BENCH_MAG_SIZE, 0, flags, NULL, NULL);
+    if (!cache)
+        return;
+
+    t = rdtsc();
+    for (i = 0; i < BENCH_MAG_LOOPS; i++)
+    {
+        for (j = 0; j < BENCH_MAG_BATCH; j++)
+            if ((objs[j] = slab_cache_alloc(cache, 0)) == NULL)
+                break;
+        while (j-- > 0)
+            slab_cache_free(cache, objs[j]);
+    }
+    t = rdtsc() - t;
+
+    kprintf("slab magazine %s: alloc+free=%u cycles, alloc hit/miss=%u/%u, "
+            "free hit/miss=%u/%u\n", name,
+            t / (BENCH_MAG_LOOPS * BENCH_MAG_BATCH),
+            cache->alloc_hits, cache->alloc_misses,
+            cache->free_hits, cache->free_misses);
+    slab_cache_delete(cache);
+}
+
+void bench_slab(void)
+{
+    size_t size;
+
+    for (size = 1024; size <= 8192; size <<= 1)
+        bench_slab_size(size);
+    bench_slab_colour();
+    bench_slab_churn("off", SLAB_NO_MAGAZINE);
+    bench_slab_churn("on", 0);
+}
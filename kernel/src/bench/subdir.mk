@@ -0,0 +1,3 @@
+local_sources := bench.c \
+				 bench_slab.c \
+				 bench_frame.c
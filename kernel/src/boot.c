@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "boot.h"
+#include "kprintf.h"
+#include "arch/x86/misc.h"  /* rdtsc */
+
+struct boot_stamp
+{
+    const char  *name;
+    uint32_t    tsc;
+};
+
+static struct boot_stamp boot_stamps[BOOT_STAMPS_MAX];
+static unsigned int boot_stamps_num;
+
+void boot_stamp(const char *name)
+{
+    if (boot_stamps_num == BOOT_STAMPS_MAX)
+        return;
+    boot_stamps[boot_stamps_num].name = name;
+    boot_stamps[boot_stamps_num].tsc = rdtsc();
+    boot_stamps_num++;
+}
+
+void boot_stamps_dump(void)
+{
+    unsigned int i;
+
+    kprintf("Boot steps (cycles)\n");
+    for (i = 1; i < boot_stamps_num; i++)
+        kprintf("  %-12s %u\n", boot_stamps[i].name,
+                boot_stamps[i].tsc - boot_stamps[i-1].tsc);
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Boot timeline.
+ * Time stamps taken while the kernel initializes, dumped once the
+ * initialization is finished.
+ */
+
+#ifndef _BEEOS_BOOT_H_
+#define _BEEOS_BOOT_H_
+
+/** Maximum number of recorded time stamps (the exceeding are dropped). */
+#define BOOT_STAMPS_MAX     16
+
+/**
+ * Record a boot time stamp.
+ *
+ * @param name  Name of the boot step just finished (not copied).
+ */
+void boot_stamp(const char *name);
+
+/**
+ * Print the recorded boot steps with the cycles spent in each one.
+ */
+void boot_stamps_dump(void);
+
+#endif /* _BEEOS_BOOT_H_ */
@@ -20,6 +20,7 @@
 #include "ext2.h"
 #include "fs/vfs.h"
 #include "kmalloc.h"
+#include "mm/slab.h"
 #include "dev.h"
 #include "util.h"
 #include "panic.h"
@@ -52,6 +53,14 @@ uint32_t block_size;
 
 int ext2_sb_inode_read(struct inode *inode);
 
+static struct slab_cache ext2_inode_cache;
+
+int ext2_init(void)
+{
+    slab_cache_init(&ext2_inode_cache, "ext2-inode-cache",
+            sizeof(struct ext2_inode), 0, 0, NULL, NULL);
+    return 0;
+}
 
 static struct inode *ext2_inode_create(dev_t dev, ino_t ino)
 {
@@ -59,7 +68,7 @@ static struct inode *ext2_inode_create(dev_t dev, ino_t ino)
     if ((inode = (struct ext2_inode *)inode_lookup(dev, ino)) != NULL)
         return &inode->base;
      
-    inode = kmalloc(sizeof(struct ext2_inode), 0);
+    inode = slab_cache_alloc(&ext2_inode_cache, 0);
     if (!inode)
         return NULL;
     inode_init(&inode->base, dev, ino);
@@ -68,9 +77,14 @@ static struct inode *ext2_inode_create(dev_t dev, ino_t ino)
 
 void ext2_inode_delete(struct inode *inode)
 {
-    kfree(inode, sizeof(struct ext2_inode));
+    slab_cache_free(&ext2_inode_cache, inode);
 }
 
+static const struct sb_ops ext2_sb_ops =
+{
+    .inode_free = ext2_inode_delete,
+};
+
 
 static int offset_to_block(off_t offset, struct ext2_inode *inode,
         struct ext2_sb *sb)
@@ -172,9 +186,14 @@ struct inode *ext2_lookup(struct inode *dir, const char *name)
             && !strncmp(dirent->name, name, dirent->name_len))
 		{ // TODO: iget first...
             inode = ext2_inode_create(dir->dev, dirent->inode);
+            if (inode == NULL)
+                break;
             inode->sb = dir->sb;
 			if (ext2_sb_inode_read(inode) != 0)
-                ext2_inode_delete(inode);
+            {
+                iput(inode);
+                inode = NULL;
+            }
             break;
 		}
 		if((dirent->rec_len) == 0)
@@ -308,7 +327,7 @@ struct sb *ext2_sb_create(dev_t dev)
     root->sb = &sb->base;
     ext2_sb_inode_read(root);
 
-    sb_init(&sb->base, dev, root, NULL);
+    sb_init(&sb->base, dev, root, &ext2_sb_ops);
 
     return &sb->base;
 }
@@ -124,6 +124,8 @@ struct ext2_fs
     vfs_ops_t *ops;
 };
 */
+int ext2_init(void);
+
 struct sb *ext2_sb_create(dev_t dev);
 
 #endif /* _BEEOS_FS_EXT2_H_ */
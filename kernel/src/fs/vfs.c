@@ -19,18 +19,19 @@
 
 #include "fs/vfs.h"
 #include "mm/slab.h"
-#include "kmalloc.h"
+#include "mm/pcache.h"
 #include "proc.h"
 #include "panic.h"
+#include "fs/ext2.h"
 
+void pipe_init(void);
 
-struct sb *ext2_sb_create(dev_t dev);
 
 // http://www.tldp.org/LDP/lki/lki-3.html
 
 struct fs_type fs_list[] =
 {
-    { "ext2",   ext2_sb_create }
+    { "ext2",   ext2_sb_create, ext2_init }
 };
 
 #define FS_LIST_LEN (sizeof(fs_list)/sizeof(fs_list[0]))
@@ -70,6 +71,8 @@ static struct htable_link *inode_htable[1 << INODE_HTABLE_BITS];
 
 int fs_init(void)
 {
+    int i;
+
     slab_cache_init(&inode_cache, "inode-cache", sizeof(struct inode),
             0, 0, NULL, NULL);
 
@@ -77,6 +80,14 @@ int fs_init(void)
             0, 0, NULL, NULL);
 
     htable_init(inode_htable, INODE_HTABLE_BITS);
+
+    pcache_init();
+
+    pipe_init();
+
+    for (i = 0; i < FS_LIST_LEN; i++)
+        if (fs_list[i].init != NULL && fs_list[i].init() != 0)
+            return -1;
     
     return 0;
 }
@@ -170,6 +181,8 @@ void inode_init(struct inode *inode, dev_t dev, ino_t ino)
     inode->ino = ino;
     inode->ref = 1;
     inode->sb = NULL;
+    inode->pages = NULL;
+    inode->mapped = 0;
     htable_insert(inode_htable, &inode->hlink, KEY(dev,ino), INODE_HTABLE_BITS);
 }
 
@@ -190,7 +203,7 @@ struct inode *iget(dev_t dev, ino_t ino)
     if ((inode = inode_lookup(dev, ino)) != NULL)
         return inode;
 
-    inode = kmalloc(sizeof(*inode), 0);
+    inode = fs_inode_alloc();
     if (!inode)
         panic("iget: no free inodes");
     inode_init(inode, dev, ino);
@@ -204,12 +217,14 @@ void iput(struct inode *ip)
         return;
     /* Check if was in the hash table (e.g. pipe inodes are not) */
     if (ip->hlink.pprev != NULL)
-    {
-        /* TODO temporary code... 
-         * If is a pipe the pipe_inode structure must be released differently */
         htable_delete(&ip->hlink); 
+    if (ip->pages != NULL)
+        pcache_release(ip);
+    /* File system specific inodes are released by their super block */
+    if (ip->sb != NULL && ip->sb->ops != NULL && ip->sb->ops->inode_free)
+        ip->sb->ops->inode_free(ip);
+    else
         slab_cache_free(&inode_cache, ip);
-    }
 }
 
 struct inode *idup(struct inode *ip)
@@ -55,6 +55,7 @@ struct fs_type
 {
     const char *name;
     struct sb *(*sb_create)(dev_t dev);
+    int (*init)(void);      /** File system initialization (optional) */
 };
 
 struct inode;
@@ -86,6 +87,8 @@ struct inode
     struct htable_link      hlink;
     struct sb   *sb;    /* Inode superblock */
     const struct inode_ops  *ops; /* VFS operations. */
+    struct pcache_page      *pages; /* Cached pages (see mm/pcache.h) */
+    int         mapped; /* Memory areas mapping the file */
 };
 
 
@@ -147,6 +150,8 @@ struct inode *iget(dev_t dev, ino_t ino);
 struct inode *idup(struct inode *inode);
 void iput(struct inode *inode);
 
+struct inode *fs_inode_alloc(void);
+
 struct inode *inode_lookup(dev_t dev, ino_t ino);
 void inode_init(struct inode *inode, dev_t dev, ino_t ino);
 struct inode *inode_create(dev_t dev, ino_t ino);
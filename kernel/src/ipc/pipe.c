@@ -21,7 +21,7 @@
 #include "fs/vfs.h"
 #include "proc.h"
 #include "sync/cond.h"
-#include "kmalloc.h"
+#include "mm/slab.h"
 #include "sys.h"
 #include <sys/types.h>
 #include <limits.h>
@@ -183,17 +183,57 @@ static const struct inode_ops pipe_ops =
     .write = pipe_write
 };
 
+static struct slab_cache pipe_inode_cache;
+
+/*
+ * Pipe inode constructor.
+ * The queue is left empty and unlocked when the last end is closed,
+ * thus it is initialized once per slab.
+ */
+static void pipe_inode_ctor(void *obj)
+{
+    struct pipe_inode *pnode = (struct pipe_inode *)obj;
+
+    cond_init(&pnode->queue);
+}
+
+static void pipe_inode_delete(struct inode *inode)
+{
+    slab_cache_free(&pipe_inode_cache, inode);
+}
+
+static const struct sb_ops pipe_sb_ops =
+{
+    .inode_free = pipe_inode_delete,
+};
+
+/* Pipes pseudo file system super block */
+static struct sb pipe_sb =
+{
+    .ops = &pipe_sb_ops,
+};
+
+void pipe_init(void)
+{
+    slab_cache_init(&pipe_inode_cache, "pipe-inode-cache",
+            sizeof(struct pipe_inode), 0, 0, pipe_inode_ctor, NULL);
+}
+
 struct inode *pipe_inode_create(void)
 {
     struct pipe_inode *pnode;
-    pnode = kmalloc(sizeof(struct pipe_inode), 0);
+    pnode = slab_cache_alloc(&pipe_inode_cache, 0);
     if (!pnode)
         return NULL;
-    memset(pnode, 0, sizeof(*pnode));
+    memset(&pnode->base, 0, sizeof(pnode->base));
+    pnode->nrp = 0;
+    pnode->nwp = 0;
+    pnode->queued_writers = 0;
+    pnode->queued_readers = 0;
+    pnode->base.sb = &pipe_sb;
     pnode->base.mode = S_IFIFO | S_IRWXU | S_IRWXG | S_IRWXO;
     pnode->base.ops = &pipe_ops;
     pnode->base.ref = 2;
-    cond_init(&pnode->queue);
     return &pnode->base;
 }
 
@@ -28,6 +28,8 @@
 #include "fs/vfs.h"
 #include "proc/task.h"
 #include "dev.h"
+#include "bench.h"
+#include "boot.h"
 #include <string.h>
 #include <stdio.h>
 #include <unistd.h>
@@ -45,6 +47,7 @@ void kmain(void)
     
     kmalloc_init();
     isr_init();
+    boot_stamp("kmalloc");
 
     /*
      * Primary
@@ -52,9 +55,11 @@ void kmain(void)
 
     timer_init(100);
     fs_init();
+    boot_stamp("fs");
     scheduler_init();
     tty_init();
     syscall_init();
+    boot_stamp("sched");
 
     /*
      * Initialization finished
@@ -67,8 +72,15 @@ void kmain(void)
     if (sb == NULL)
         panic("Unable to mount root file system");
     current_task->cwd = sb->root;
+    boot_stamp("rootfs");
 
     kprintf("\n");
+    boot_stamps_dump();
+    kprintf("\n");
+
+#ifdef BENCH
+    bench_run();
+#endif
 
     /*
      * Fork and start the init process
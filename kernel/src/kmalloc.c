@@ -20,38 +20,101 @@
 #include "kmalloc.h"
 #include "mm/slab.h"
 #include "util.h"
+#include "kprintf.h"
 
-#define KMALLOC_MIN_W   4
-#define KMALLOC_MAX_W   22  
+/*
+ * Size classes.
+ *
+ * Up to 4K each power of two is paired with an intermediate class at 3/4 of
+ * the next power (48, 96, ..., 3072), this halves the worst case internal
+ * fragmentation for the most common object sizes.  Above 4K the classes are
+ * plain powers of two up to 4M.
+ */
+#define KMALLOC_CLASSES         26
+#define KMALLOC_LOOKUP_MAX      4096    /**< Biggest size using the table */
+#define KMALLOC_GRANULE_W       4       /**< Lookup table granularity */
+#define KMALLOC_LOOKUP_CLASS    15      /**< Class of KMALLOC_LOOKUP_MAX */
 
+/** Generic cache descriptor and waste statistics */
+struct kmalloc_class
+{
+    size_t size;                /**< Slot size */
+    const char *name;           /**< Slab cache name */
+    struct slab_cache *cache;   /**< Backing slab cache */
+    unsigned long allocs;       /**< Total number of allocations */
+    unsigned long live;         /**< Currently allocated objects */
+    unsigned long wasted;       /**< Total bytes wasted by all allocations */
+};
 
 static int kmalloc_initialized = 0;
 
-static struct slab_cache *kmalloc_caches[KMALLOC_MAX_W - KMALLOC_MIN_W + 1];
+static struct kmalloc_class kmalloc_classes[KMALLOC_CLASSES] =
+{
+    { 16,        "kmalloc-16"   },
+    { 32,        "kmalloc-32"   },
+    { 48,        "kmalloc-48"   },
+    { 64,        "kmalloc-64"   },
+    { 96,        "kmalloc-96"   },
+    { 128,       "kmalloc-128"  },
+    { 192,       "kmalloc-192"  },
+    { 256,       "kmalloc-256"  },
+    { 384,       "kmalloc-384"  },
+    { 512,       "kmalloc-512"  },
+    { 768,       "kmalloc-768"  },
+    { 1024,      "kmalloc-1K"   },
+    { 1536,      "kmalloc-1536" },
+    { 2048,      "kmalloc-2K"   },
+    { 3072,      "kmalloc-3K"   },
+    { 4096,      "kmalloc-4K"   },
+    { 8 << 10,   "kmalloc-8K"   },
+    { 16 << 10,  "kmalloc-16K"  },
+    { 32 << 10,  "kmalloc-32K"  },
+    { 64 << 10,  "kmalloc-64K"  },
+    { 128 << 10, "kmalloc-128K" },
+    { 256 << 10, "kmalloc-256K" },
+    { 512 << 10, "kmalloc-512K" },
+    { 1 << 20,   "kmalloc-1M"   },
+    { 2 << 20,   "kmalloc-2M"   },
+    { 4 << 20,   "kmalloc-4M"   },
+};
 
-static const char *kmalloc_names[] =
+/*
+ * Size to class lookup table for sizes up to KMALLOC_LOOKUP_MAX.
+ * Entry 'i' holds the class of sizes in the range (i*16, (i+1)*16].
+ */
+static const unsigned char
+kmalloc_lookup[KMALLOC_LOOKUP_MAX >> KMALLOC_GRANULE_W] =
 {
-    "kmalloc-16",
-	"kmalloc-32",
-	"kmalloc-64",
-	"kmalloc-128",
-	"kmalloc-256",
-	"kmalloc-512",
-	"kmalloc-1K",
-	"kmalloc-2K",
-	"kmalloc-4K",
-	"kmalloc-8K",
-	"kmalloc-16K",
-	"kmalloc-32K",
-	"kmalloc-64K",
-	"kmalloc-128K",
-	"kmalloc-256K",
-	"kmalloc-512K",
-	"kmalloc-1M",
-	"kmalloc-2M",
-	"kmalloc-4M"
+    [0 ... 0]       = 0,    /* 16 */
+    [1 ... 1]       = 1,    /* 32 */
+    [2 ... 2]       = 2,    /* 48 */
+    [3 ... 3]       = 3,    /* 64 */
+    [4 ... 5]       = 4,    /* 96 */
+    [6 ... 7]       = 5,    /* 128 */
+    [8 ... 11]      = 6,    /* 192 */
+    [12 ... 15]     = 7,    /* 256 */
+    [16 ... 23]     = 8,    /* 384 */
+    [24 ... 31]     = 9,    /* 512 */
+    [32 ... 47]     = 10,   /* 768 */
+    [48 ... 63]     = 11,   /* 1K */
+    [64 ... 95]     = 12,   /* 1536 */
+    [96 ... 127]    = 13,   /* 2K */
+    [128 ... 191]   = 14,   /* 3K */
+    [192 ... 255]   = 15,   /* 4K */
 };
 
+/* Map a request size to its class index (KMALLOC_CLASSES if too big). */
+static inline unsigned int kmalloc_index(size_t size)
+{
+    unsigned int i;
+
+    if (size <= KMALLOC_LOOKUP_MAX)
+        return kmalloc_lookup[(size - (size != 0)) >> KMALLOC_GRANULE_W];
+    i = KMALLOC_LOOKUP_CLASS +
+        fnzb(next_pow2(size) / KMALLOC_LOOKUP_MAX);
+    return MIN(i, KMALLOC_CLASSES);
+}
+
 
 /* 
  * Very primitive memory allocation form.
@@ -73,41 +136,76 @@ static void *ksbrk(intptr_t increment)
 void *kmalloc(size_t size, int flags)
 {
     unsigned int i;
+    void *ptr;
+    struct kmalloc_class *kc;
+
     if (!kmalloc_initialized)
         return ksbrk(size);
-    i = (size < 16) ? 16 : next_pow2(size);
-    i >>= 4;
-    i = fnzb(i);
-    return slab_cache_alloc(kmalloc_caches[i], flags);
+    i = kmalloc_index(size);
+    if (i >= KMALLOC_CLASSES)
+        return NULL;
+    kc = &kmalloc_classes[i];
+    ptr = slab_cache_alloc(kc->cache, flags);
+    if (ptr) {
+        kc->allocs++;
+        kc->live++;
+        kc->wasted += kc->size - size;
+        kc->cache->req_wasted += kc->size - size;
+    }
+    return ptr;
 }
 
 void kfree(void *ptr, size_t size)
 {
     unsigned int i;
-    if (!kmalloc_initialized)
+    struct kmalloc_class *kc;
+
+    if (!kmalloc_initialized || !ptr)
+        return;
+    i = kmalloc_index(size);
+    if (i >= KMALLOC_CLASSES)
         return;
-    i= (size < 16) ? 16 : next_pow2(size);
-    i >>= 4;
-    i = fnzb(i);
-    slab_cache_free(kmalloc_caches[i], ptr);
+    kc = &kmalloc_classes[i];
+    kc->live--;
+    kc->cache->req_wasted -= kc->size - size;
+    slab_cache_free(kc->cache, ptr);
 }
 
 /* Initialize generic kernel memory allocator. */
 void kmalloc_init(void)
 {
     int i;
-    size_t size;
 
     /* Initialize the slab subsystem */
     slab_init();
 
-    for (i = 0, size = (1 << KMALLOC_MIN_W);
-         i < KMALLOC_MAX_W - KMALLOC_MIN_W + 1;
-         i++, size <<= 1)
-    {
-        kmalloc_caches[i] = slab_cache_create(kmalloc_names[i],
-                size, 0, 0, NULL, NULL);
-    }
+    for (i = 0; i < KMALLOC_CLASSES; i++)
+        kmalloc_classes[i].cache = slab_cache_create(kmalloc_classes[i].name,
+                kmalloc_classes[i].size, 0, 0, NULL, NULL);
     kmalloc_initialized = 1;
 }
 
+/*
+ * Dump the generic caches usage counters.
+ * For each used class the live objects waste (slot bytes not requested by
+ * the callers) and the average waste of all the allocations is reported.
+ */
+void kmalloc_dump(void)
+{
+    int i;
+    struct kmalloc_class *kc;
+
+    kprintf("%-14s %8s %8s %10s %8s\n",
+            "class", "allocs", "live", "live-waste", "avg-waste");
+    for (i = 0; i < KMALLOC_CLASSES; i++) {
+        kc = &kmalloc_classes[i];
+        if (kc->allocs == 0)
+            continue;
+        kprintf("%-14s %8u %8u %10u %8u\n", kc->name, kc->allocs, kc->live,
+                kc->cache->req_wasted,
+                kc->wasted / kc->allocs);
+    }
+    for (i = 0; i < KMALLOC_CLASSES; i++)
+        if (kmalloc_classes[i].allocs != 0)
+            slab_cache_dump(kmalloc_classes[i].cache);
+}
@@ -28,4 +28,6 @@ void kfree(void *ptr, size_t size);
 
 void kmalloc_init(void);
 
+void kmalloc_dump(void);
+
 #endif
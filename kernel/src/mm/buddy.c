@@ -39,9 +39,59 @@ static int toggle_bit(struct buddy_sys *ctx, int block_idx,
 
     i = block_idx >> (order + 1);
     word = &ctx->free_area[order].map[i / (8 * sizeof(unsigned long))];
-    bit = 1 << i % (8 * sizeof(unsigned long));
+    bit = 1UL << (i % (8 * sizeof(unsigned long)));
     *word ^= bit;           /* Toggle the bit value */
-    return *word & bit;     /* Return the current value */
+    return (*word & bit) != 0; /* Return the current value */
+}
+
+/*
+ * Free lists handling.
+ * The free blocks counter and the non empty orders bitmap are kept in sync
+ * with the lists content.
+ */
+static void free_area_insert(struct buddy_sys *ctx, unsigned int block_idx,
+        unsigned int order)
+{
+    list_insert_before(&ctx->free_area[order].list,
+            &ctx->frames[block_idx].link);
+    ctx->free_area[order].count++;
+    ctx->free_orders |= (1UL << order);
+}
+
+static void free_area_delete(struct buddy_sys *ctx, unsigned int block_idx,
+        unsigned int order)
+{
+    list_delete(&ctx->frames[block_idx].link);
+    if (--ctx->free_area[order].count == 0)
+        ctx->free_orders &= ~(1UL << order);
+}
+
+/*
+ * Smallest order, greater or equal to 'order', with a free block.
+ * Returns a value greater than order_max if there is no such block.
+ */
+static unsigned int free_area_find(struct buddy_sys *ctx, unsigned int order)
+{
+    unsigned long mask = ctx->free_orders & ~((1UL << order) - 1);
+
+    return (mask != 0) ? lnzb(mask) : ctx->order_max + 1;
+}
+
+/*
+ * Remove the first block of the given order from its free list.
+ */
+static unsigned int free_area_get(struct buddy_sys *ctx, unsigned int order)
+{
+    struct frame *frame;
+    unsigned int block_idx;
+
+    frame = list_container(ctx->free_area[order].list.next,
+            struct frame, link);
+    block_idx = frame - ctx->frames;
+    free_area_delete(ctx, block_idx, order);
+    if (order != ctx->order_max) /* Order max does't have any buddy */
+        toggle_bit(ctx, block_idx, order);
+    return block_idx;
 }
 
 /*
@@ -64,7 +114,7 @@ void buddy_free(struct buddy_sys *ctx, struct frame *frame, unsigned int order)
             break;
 
         /* Remove the buddy from its free list */
-        list_delete(&ctx->frames[buddy_idx].link);
+        free_area_delete(ctx, buddy_idx, order);
         /* Coalesce into one bigger block */
         order++;
 
@@ -74,8 +124,31 @@ void buddy_free(struct buddy_sys *ctx, struct frame *frame, unsigned int order)
     }
     
     /* Insert the block at the end of the proper list */
-    list_insert_before(&ctx->free_area[order].list,
-            &ctx->frames[block_idx].link);
+    free_area_insert(ctx, block_idx, order);
+}
+
+/*
+ * Deallocate a range of frames.
+ * Two buddies can't both be maximal blocks of the range, thus only the
+ * blocks at the range boundaries may coalesce with free neighbours.
+ */
+void buddy_free_range(struct buddy_sys *ctx, struct frame *frame,
+        unsigned int count)
+{
+    unsigned int idx, end, order;
+
+    idx = frame - ctx->frames;
+    end = idx + count;
+    while (idx < end)
+    {
+        /* Biggest block aligned to idx and within the range */
+        order = (idx != 0) ? lnzb(idx) : ctx->order_max;
+        order = MIN(order, ctx->order_max);
+        while ((1U << order) > end - idx)
+            order--;
+        buddy_free(ctx, &ctx->frames[idx], order);
+        idx += (1U << order);
+    }
 }
 
 /*
@@ -83,43 +156,64 @@ void buddy_free(struct buddy_sys *ctx, struct frame *frame, unsigned int order)
  */
 struct frame *buddy_alloc(struct buddy_sys *ctx, unsigned int order)
 {
-    struct frame *frame = NULL;
-    int left_idx, right_idx;
+    unsigned int left_idx, right_idx;
     unsigned int i;
 
-    for (i = order; i <= ctx->order_max; i++)
-    {
-        if (!list_empty(&ctx->free_area[i].list))
-        {
-            frame = list_container(ctx->free_area[i].list.next, 
-                    struct frame, link); 
-            list_delete(&frame->link);
-            left_idx = frame - ctx->frames;
-            break;
-        }
-    }
+    i = free_area_find(ctx, order);
     if (i > ctx->order_max)
         return NULL;
-
-    if (i != ctx->order_max) /* Order max does't have any buddy */
-        toggle_bit(ctx, left_idx, i);
+    left_idx = free_area_get(ctx, i);
 
     /* Eventually split */
     while (i > order)
     {
         i--;
         right_idx = left_idx + (1 << i);
-        list_insert_before(&ctx->free_area[i].list, &ctx->frames[right_idx].link);
+        free_area_insert(ctx, right_idx, i);
         toggle_bit(ctx, right_idx, i);
     }
-    return frame;
+    return &ctx->frames[left_idx];
+}
+
+/*
+ * Allocate order zero frames in bulk.
+ * A block is split only while it is bigger than the remaining request,
+ * then all its frames are handed out at once. As for a single block
+ * allocation, the couple bits below the block order are already clear.
+ */
+unsigned int buddy_alloc_bulk(struct buddy_sys *ctx, unsigned int count,
+        struct frame **frames)
+{
+    unsigned int left_idx, right_idx;
+    unsigned int i, n = 0;
+
+    while (n < count)
+    {
+        i = free_area_find(ctx, 0);
+        if (i > ctx->order_max)
+            break;
+        left_idx = free_area_get(ctx, i);
+
+        while ((1U << i) > count - n)
+        {
+            i--;
+            right_idx = left_idx + (1 << i);
+            free_area_insert(ctx, right_idx, i);
+            toggle_bit(ctx, right_idx, i);
+        }
+
+        right_idx = left_idx + (1 << i);
+        while (left_idx < right_idx)
+            frames[n++] = &ctx->frames[left_idx++];
+    }
+    return n;
 }
 
 /*
  * Initialize a buddy allocator
  */
 int buddy_init(struct buddy_sys *ctx, unsigned int frames_num, 
-        unsigned int frame_size)
+        unsigned int frame_size, struct frame *frames)
 {
     unsigned int i;
     unsigned int count;
@@ -149,18 +243,19 @@ int buddy_init(struct buddy_sys *ctx, unsigned int frames_num,
             panic("Buddy init");
         memset(ctx->free_area[i].map, 0, sizeof(unsigned long) * count);
         list_init(&ctx->free_area[i].list);
+        ctx->free_area[i].count = 0;
     }
     /* Initialize the last (order_max) entry with a null buddy */
     list_init(&ctx->free_area[i].list);
     ctx->free_area[i].map = NULL;
+    ctx->free_area[i].count = 0;
+    ctx->free_orders = 0;
 
     /*
-     * Create the frames list
+     * Initialize the frames list
      */
 
-    ctx->frames = kmalloc(frames_num * sizeof(struct frame), 0);
-    if (!ctx->frames)
-        panic("Buddy init");
+    ctx->frames = frames;
     for (i = 0; i < frames_num; i++)
     {
         list_init(&ctx->frames[i].link);
@@ -169,6 +264,11 @@ int buddy_init(struct buddy_sys *ctx, unsigned int frames_num,
     return 0;
 }
 
+unsigned int buddy_free_count(struct buddy_sys *ctx, unsigned int order)
+{
+    return ctx->free_area[order].count;
+}
+
 /*
  * Dump buddy status
  */
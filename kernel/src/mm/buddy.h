@@ -22,6 +22,8 @@
 
 #include "list.h"
 
+struct zone_st;
+
 /** Physical memory frame structure. */
 struct frame
 {
@@ -34,6 +36,10 @@ struct frame
      * E.g. if allocated by slab, this points there.
      */
     void                *ctx;
+    /** Number of present entries, if the frame is a page table. */
+    unsigned int        present;
+    /** Owner memory zone (NULL if the frame is not managed). */
+    struct zone_st      *zone;
 };
 
 /** List of free frames with the same order. */
@@ -43,6 +49,8 @@ struct free_list
     struct list_link    list;
     /** Bitmap used to keep track of the state of each couple of buddies. */
     unsigned long       *map;
+    /** Number of free blocks in the list. */
+    unsigned int        count;
 };
 
 /** 
@@ -57,6 +65,8 @@ struct buddy_sys
     unsigned int        order_max;
     /** Free frames list, one element for each order (order_max+1) */
     struct free_list    *free_area;
+    /** Bitmap of the orders with a non empty free list. */
+    unsigned long       free_orders;
     /** Frames support structures (e.g. for the freelist) */
     struct frame        *frames;
 };
@@ -67,10 +77,11 @@ struct buddy_sys
  * @param ctx           Buddy system context pointer.
  * @param frames_num    Number of frames to be handled.
  * @param frame_size    Size of a single memory frame.
+ * @param frames        Frames descriptors array (frames_num elements).
  * @return              Zero on success. A value less than zero on failure.
  */
 int buddy_init(struct buddy_sys *ctx, unsigned int frames_num,
-        unsigned int frame_size);
+        unsigned int frame_size, struct frame *frames);
 
 /**
  * Allocate a chunk of memory of the specified order.
@@ -82,6 +93,20 @@ int buddy_init(struct buddy_sys *ctx, unsigned int frames_num,
  */
 struct frame *buddy_alloc(struct buddy_sys *ctx, unsigned int order);
 
+/**
+ * Allocate a number of order zero chunks.
+ * Bigger blocks are split once to serve as many frames as possible,
+ * instead of being split down to a single frame for each request.
+ *
+ * @param ctx       Buddy system context pointer.
+ * @param count     Number of requested frames.
+ * @param frames    Array filled with the allocated frames.
+ * @return          Number of allocated frames (less than count if
+ *                  the memory is exhausted).
+ */
+unsigned int buddy_alloc_bulk(struct buddy_sys *ctx, unsigned int count,
+        struct frame **frames);
+
 /**
  * Release a chunk of memory.
  *
@@ -91,6 +116,27 @@ struct frame *buddy_alloc(struct buddy_sys *ctx, unsigned int order);
  */
 void buddy_free(struct buddy_sys *ctx, struct frame *frame, unsigned int order);
 
+/**
+ * Release a range of allocated frames.
+ * The range is split in the biggest aligned blocks, each released with
+ * a single free operation, instead of releasing one frame at a time.
+ *
+ * @param ctx       Buddy system context pointer.
+ * @param frame     First frame of the range.
+ * @param count     Number of frames in the range.
+ */
+void buddy_free_range(struct buddy_sys *ctx, struct frame *frame,
+        unsigned int count);
+
+/**
+ * Number of free memory chunks of the specified order.
+ *
+ * @param ctx       Buddy system context pointer.
+ * @param order     Memory chunk order.
+ * @return          Number of free chunks.
+ */
+unsigned int buddy_free_count(struct buddy_sys *ctx, unsigned int order);
+
 /**
  * Prints buddy system status.
  *
@@ -21,11 +21,51 @@
 #include "zone.h"
 #include "kmalloc.h"
 #include "kprintf.h"
+#include "util.h"
+#include <string.h>
+
+struct frame *mem_map;
+size_t mem_map_frames;
 
 /* List of all the registered zones */
 static struct zone_st *zone_list;
 
-void *frame_alloc(unsigned int order, int flags)
+/* List of the registered shrinkers */
+static struct list_link shrinkers = { &shrinkers, &shrinkers };
+
+/* Prevents shrinkers recursion */
+static int reclaiming;
+
+void shrinker_register(struct shrinker *shrinker)
+{
+    list_insert_before(&shrinkers, &shrinker->link);
+}
+
+void shrinker_unregister(struct shrinker *shrinker)
+{
+    list_delete(&shrinker->link);
+}
+
+size_t frame_reclaim(size_t count)
+{
+    struct list_link *link;
+    struct shrinker *shrinker;
+    size_t freed = 0;
+
+    if (reclaiming)
+        return 0;
+    reclaiming = 1;
+    for (link = shrinkers.next; link != &shrinkers && freed < count;
+         link = link->next) {
+        shrinker = list_container(link, struct shrinker, link);
+        freed += shrinker->shrink(shrinker, count - freed);
+    }
+    reclaiming = 0;
+    return freed;
+}
+
+static void *frame_zone_alloc(unsigned int order, int flags,
+        struct zone_st **zonep)
 {
     void *ptr = NULL;
     struct zone_st *zone;
@@ -37,37 +77,155 @@ void *frame_alloc(unsigned int order, int flags)
         if (ptr)
             break;
     }
+    *zonep = zone;
     return ptr;
 }
 
-void frame_free(void *ptr, unsigned int order)
+void *frame_alloc(unsigned int order, int flags)
 {
+    void *ptr;
     struct zone_st *zone;
 
+    ptr = frame_zone_alloc(order, flags, &zone);
+    if (!ptr) {
+        /* Zones exhausted, try to get back some cached memory */
+        if (frame_reclaim(1 << order) > 0)
+            ptr = frame_zone_alloc(order, flags, &zone);
+    } else if (zone->free_count < zone->free_low) {
+        frame_reclaim(zone->free_low - zone->free_count);
+    }
+    return ptr;
+}
+
+static unsigned int frame_zone_alloc_bulk(unsigned int count, int flags,
+        void **ptrs)
+{
+    unsigned int n = 0;
+    struct zone_st *zone;
+
+    for (zone = zone_list; zone != NULL && n < count; zone = zone->next) {
+        if ((zone->flags & flags) != flags)
+            continue;
+        n += zone_alloc_bulk(zone, count - n, ptrs + n);
+        if (zone->free_count < zone->free_low)
+            frame_reclaim(zone->free_low - zone->free_count);
+    }
+    return n;
+}
+
+unsigned int frame_alloc_bulk(unsigned int count, int flags, void **ptrs)
+{
+    unsigned int n;
+
+    n = frame_zone_alloc_bulk(count, flags, ptrs);
+    if (n < count) {
+        /* Zones exhausted, try to get back some cached memory */
+        if (frame_reclaim(count - n) > 0)
+            n += frame_zone_alloc_bulk(count - n, flags, ptrs + n);
+    }
+    return n;
+}
+
+void frame_free(void *ptr, unsigned int order)
+{
+    struct frame *frame;
+
     if (!ptr)
         return;
-    for (zone = zone_list; zone != NULL; zone = zone->next) {
-        if (iswithin((uintptr_t)zone->addr, zone->size,
-                     (uintptr_t)ptr, 4096<<order)) {
-            zone_free(zone, ptr, order);
+    frame = frame_desc(ptr);
+    if (frame && frame->zone)
+        zone_free(frame->zone, ptr, order);
+}
+
+void frame_free_bulk(void **ptrs, unsigned int count)
+{
+    struct frame *frame, *next;
+    unsigned int i, n;
+
+    for (i = 0; i < count; i += n) {
+        frame = frame_desc(ptrs[i]);
+        if (!frame || !frame->zone) {
+            n = 1;
+            continue;
+        }
+        /* Gather the following frames of the same zone */
+        for (n = 1; i + n < count; n++) {
+            next = frame_desc(ptrs[i + n]);
+            if (!next || next->zone != frame->zone)
+                break;
+        }
+        zone_free_bulk(frame->zone, ptrs + i, n);
+    }
+}
+
+void frame_free_range(void *start, void *end)
+{
+    struct frame *frame;
+    struct zone_st *zone;
+    char *ptr = start, *zend;
+
+    while (ptr < (char *)end) {
+        frame = frame_desc(ptr);
+        if (!frame)
             break;
+        zone = frame->zone;
+        if (!zone) {
+            ptr += (1 << FRAME_SHIFT);
+            continue;
         }
+        zend = MIN(zone->addr + zone->size, (char *)end);
+        zone_free_range(zone, ptr, (zend - ptr) >> FRAME_SHIFT);
+        ptr = zend;
     }
 }
 
+int frame_init(void *mem_end)
+{
+    mem_map_frames = (uintptr_t)mem_end >> FRAME_SHIFT;
+    mem_map = kmalloc(mem_map_frames * sizeof(struct frame), 0);
+    if (!mem_map)
+        return -1;
+    memset(mem_map, 0, mem_map_frames * sizeof(struct frame));
+    return 0;
+}
+
 int frame_zone_add(void *addr, size_t size, size_t frame_size, int flags)
 {
     struct zone_st *zone;
-    
+    size_t pfn = (uintptr_t)addr >> FRAME_SHIFT;
+
+    if (frame_size != (1 << FRAME_SHIFT) ||
+        pfn + size / frame_size > mem_map_frames)
+        return -1;
     zone = kmalloc(sizeof(struct zone_st), 0);
     if (!zone)
         return -1;
-    zone_init(zone, addr, size, frame_size, flags);
+    zone_init(zone, addr, size, frame_size, flags, &mem_map[pfn]);
     zone->next = zone_list;
     zone_list = zone;
     return 0; 
 }
 
+int frame_stat(struct kmem_zone_stat *buf, int count)
+{
+    struct zone_st *zone;
+    struct kmem_zone_stat *st;
+    unsigned int i;
+    int n = 0;
+
+    for (zone = zone_list; zone != NULL && n < count; zone = zone->next) {
+        st = &buf[n++];
+        st->flags = zone->flags;
+        st->frame_size = zone->frame_size;
+        st->frames = zone->free_count + zone->busy_count;
+        st->free = zone->free_count;
+        st->orders = MIN(zone->buddy.order_max + 1, KMEM_ORDER_MAX);
+        for (i = 0; i < st->orders; i++)
+            st->free_blocks[i] = buddy_free_count(&zone->buddy, i);
+    }
+    return n;
+}
+
 void frame_dump(void)
 {
     struct zone_st *zone;
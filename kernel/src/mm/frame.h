@@ -21,7 +21,72 @@
 #define _BEEOS_MM_FRAME_H_
 
 #include "mm/zone.h"
+#include "list.h"
 #include <sys/types.h>
+#include <sys/kmem.h>
+#include <stdint.h>
+
+/** Log2 of the frames size, the only size handled by the mem_map. */
+#define FRAME_SHIFT     12
+
+/**
+ * Physical memory map.
+ * Descriptors of all the physical frames, indexed by frame number
+ * (physical address >> FRAME_SHIFT).
+ */
+extern struct frame *mem_map;
+
+/** Number of entries in the physical memory map. */
+extern size_t mem_map_frames;
+
+/**
+ * Get the descriptor of a physical frame.
+ *
+ * @param ptr   Frame physical address.
+ * @return      Frame descriptor, NULL if the address is outside the map.
+ */
+static inline struct frame *frame_desc(void *ptr)
+{
+    size_t pfn = (uintptr_t)ptr >> FRAME_SHIFT;
+
+    return (pfn < mem_map_frames) ? &mem_map[pfn] : NULL;
+}
+
+/**
+ * Memory shrinker.
+ * Registered by the subsystems caching unused frames (e.g. slab caches).
+ * Shrinkers are invoked when a zone is exhausted or its free frames fall
+ * below the zone watermark.
+ */
+struct shrinker
+{
+    /** Shrinkers list link. */
+    struct list_link    link;
+    /**
+     * Release cached memory.
+     * The function must not allocate frames.
+     *
+     * @param shrinker  Shrinker structure.
+     * @param count     Number of frames the allocator would like back.
+     * @return          Number of released frames.
+     */
+    size_t (*shrink)(struct shrinker *shrinker, size_t count);
+};
+
+/**
+ * Add a reference to an allocated physical page.
+ * The page is released by frame_free only when the last reference is
+ * dropped (e.g. pages shared copy on write).
+ *
+ * @param ptr   Memory physical address.
+ */
+static inline void frame_ref(void *ptr)
+{
+    struct frame *frame = frame_desc(ptr);
+
+    if (frame && frame->zone)
+        frame->refs++;
+}
 
 /**
  * Allocate a physical memory page.
@@ -32,6 +97,18 @@
  */
 void *frame_alloc(unsigned int order, int flags);
 
+/**
+ * Allocate a number of physical memory pages (order zero).
+ * Much cheaper than the equivalent sequence of single allocations.
+ *
+ * @param count Number of requested pages.
+ * @param flags Allocation flags.
+ * @param ptrs  Array filled with the pages physical addresses.
+ * @return      Number of allocated pages. If less than count, the
+ *              allocated pages are anyway returned.
+ */
+unsigned int frame_alloc_bulk(unsigned int count, int flags, void **ptrs);
+
 /**
  * Free a physical memory page.
  *
@@ -40,8 +117,36 @@ void *frame_alloc(unsigned int order, int flags);
  */
 void frame_free(void *ptr, unsigned int order);
 
+/**
+ * Free a number of physical memory pages (order zero).
+ * Consecutive pages within the same zone are released as a batch.
+ *
+ * @param ptrs  Pages physical addresses.
+ * @param count Number of pages.
+ */
+void frame_free_bulk(void **ptrs, unsigned int count);
+
+/**
+ * Free a range of physical memory pages, possibly spanning multiple zones.
+ * Used to hand the initially busy zones memory to the allocator.
+ *
+ * @param start Range start physical address (page aligned).
+ * @param end   Range end physical address.
+ */
+void frame_free_range(void *start, void *end);
+
+/**
+ * Initialize the physical memory map.
+ * Must be called before any zone is added.
+ *
+ * @param mem_end   End of the physical memory.
+ * @return          0 on success, -1 on error.
+ */
+int frame_init(void *mem_end);
+
 /**
  * Add a memory zone to the frame allocator.
+ * The zone must be within the physical memory map.
  *
  * @param addr          Zone frame address.
  * @param size          Size of the zone.
@@ -51,6 +156,37 @@ void frame_free(void *ptr, unsigned int order);
  */
 int frame_zone_add(void *addr, size_t size, size_t frame_size, int flags);
 
+/**
+ * Register a memory shrinker.
+ *
+ * @param shrinker  Shrinker structure.
+ */
+void shrinker_register(struct shrinker *shrinker);
+
+/**
+ * Unregister a memory shrinker.
+ *
+ * @param shrinker  Shrinker structure.
+ */
+void shrinker_unregister(struct shrinker *shrinker);
+
+/**
+ * Run the registered shrinkers.
+ *
+ * @param count Number of frames to reclaim.
+ * @return      Number of reclaimed frames.
+ */
+size_t frame_reclaim(size_t count);
+
+/**
+ * Get a snapshot of the memory zones counters.
+ *
+ * @param buf   Records buffer.
+ * @param count Number of records in the buffer.
+ * @return      Number of records stored in the buffer.
+ */
+int frame_stat(struct kmem_zone_stat *buf, int count);
+
 /**
  * Frame allocator dump function.
  */
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "pcache.h"
+#include "frame.h"
+#include "slab.h"
+#include "htable.h"
+#include "fs/vfs.h"
+#include "util.h"
+#include <stdint.h>
+
+struct pcache_page
+{
+    struct htable_link  hlink;  /**< Cache hash table link */
+    struct pcache_page  *next;  /**< Next page of the same inode */
+    struct inode        *inode; /**< File inode */
+    off_t               offset; /**< File offset */
+    void                *frame; /**< Page frame physical address */
+};
+
+static struct slab_cache pcache_cache;
+
+#define PCACHE_HTABLE_BITS  8
+static struct htable_link *pcache_htable[1 << PCACHE_HTABLE_BITS];
+
+#define KEY(inode, offset) \
+    ((uintptr_t)(inode) + ((offset) >> FRAME_SHIFT))
+
+void pcache_init(void)
+{
+    slab_cache_init(&pcache_cache, "pcache-cache",
+            sizeof(struct pcache_page), 0, 0, NULL, NULL);
+    htable_init(pcache_htable, PCACHE_HTABLE_BITS);
+}
+
+void *pcache_lookup(struct inode *inode, off_t offset)
+{
+    struct pcache_page *pg;
+    struct htable_link *lnk;
+
+    if (inode->pages == NULL)
+        return NULL;
+    lnk = htable_lookup(pcache_htable, KEY(inode, offset),
+            PCACHE_HTABLE_BITS);
+    while (lnk != NULL) {
+        pg = struct_ptr(lnk, struct pcache_page, hlink);
+        if (pg->inode == inode && pg->offset == offset)
+            return pg->frame;
+        lnk = lnk->next;
+    }
+    return NULL;
+}
+
+int pcache_insert(struct inode *inode, off_t offset, void *frame)
+{
+    struct pcache_page *pg;
+
+    pg = slab_cache_alloc(&pcache_cache, 0);
+    if (pg == NULL)
+        return -1;
+    pg->inode = inode;
+    pg->offset = offset;
+    pg->frame = frame;
+    frame_ref(frame);
+    htable_insert(pcache_htable, &pg->hlink, KEY(inode, offset),
+            PCACHE_HTABLE_BITS);
+    pg->next = inode->pages;
+    inode->pages = pg;
+    return 0;
+}
+
+void pcache_release(struct inode *inode)
+{
+    struct pcache_page *pg;
+
+    while ((pg = inode->pages) != NULL) {
+        inode->pages = pg->next;
+        htable_delete(&pg->hlink);
+        frame_free(pg->frame, 0);
+        slab_cache_free(&pcache_cache, pg);
+    }
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * File pages cache.
+ * The read only file backed areas (e.g. the programs text) of all the
+ * processes share the same physical frames. The frames are indexed by
+ * inode and file offset and are released together with the inode, that is
+ * when the last process mapping the file releases it, or when the file is
+ * written. A file can't be written while it is mapped (see sys_write).
+ */
+
+#ifndef _BEEOS_MM_PCACHE_H_
+#define _BEEOS_MM_PCACHE_H_
+
+#include <sys/types.h>
+
+struct inode;
+
+/** Cached file page. */
+struct pcache_page;
+
+/**
+ * Initialize the file pages cache.
+ */
+void pcache_init(void);
+
+/**
+ * Find a cached file page.
+ *
+ * @param inode     File inode.
+ * @param offset    File offset (page aligned).
+ * @return          Physical address of the page frame, NULL if not cached.
+ */
+void *pcache_lookup(struct inode *inode, off_t offset);
+
+/**
+ * Add a file page to the cache.
+ * The cache takes a reference to the frame.
+ *
+ * @param inode     File inode.
+ * @param offset    File offset (page aligned).
+ * @param frame     Physical address of the page frame.
+ * @return          Zero on success, -1 if there is no memory.
+ */
+int pcache_insert(struct inode *inode, off_t offset, void *frame);
+
+/**
+ * Drop all the cached pages of a file.
+ * The frames are freed when no more mapped by a process.
+ *
+ * @param inode     File inode.
+ */
+void pcache_release(struct inode *inode);
+
+#endif /* _BEEOS_MM_PCACHE_H_ */
@@ -48,11 +48,27 @@
 #define BUFCTL_TO_BUF(bctl, objsz) \
     ((char *)(bctl) + sizeof(struct bufctl *) - (objsz))
 
-/* Flags */
+/* Cache line size, used as default slab colour offset step */
+#define SLAB_COLOUR_ALIGN   64
+
+/* Private flags (public ones are defined in the header) */
 #define SLAB_EMBED_BUFCTL       (1 << 0)    // bufctl is at buf end
 #define SLAB_EMBED_SLABCTL      (1 << 1)    // slabctl is at slab end
 #define SLAB_OPTIMIZE           (1 << 2)
 
+/* Objects held by a single magazine */
+#define SLAB_MAG_ROUNDS         15
+/* Maximum number of full magazines retained by a cache depot */
+#define SLAB_DEPOT_MAX          4
+
+/* Bufctl hash table minimum size */
+#define SLAB_HASH_MIN           32
+/* Old hash table buckets moved by each hash operation while resizing */
+#define SLAB_REHASH_STEP        2
+
+/* Default number of empty slabs retained by a cache when reaping */
+#define SLAB_RESERVE            1
+
 /*
  * The bufctl (buffer control) structure keeps some minimal information
  * about each buffer: its address, its slab, and its current linkage,
@@ -75,11 +91,25 @@ struct slabctl
 {
     unsigned int        inuse;  /* Entries in use */
     struct list_link    link;   /* Full, partial, free list link */
-    void                *data;  /* Address of the first available item */
+    void                *data;  /* Address of the first (coloured) item */
     struct htable_link  *bctls; /* List of free bufctls (exploiting hlist) */
     struct slab_cache   *cache; /* Slab cache pointer */
 };
 
+/*
+ * A magazine is an array of already constructed objects with a count of
+ * the number of rounds (valid pointers) it holds. Each cache keeps a
+ * loaded and a previous magazine so that the common alloc and free pair
+ * reduces to a pop and a push. Full and empty magazines are exchanged with
+ * the cache depot, the slab layer is involved only on depot misses.
+ */
+struct slab_magazine
+{
+    struct list_link    link;   /* Depot list link */
+    unsigned int        rounds; /* Objects in the magazine */
+    void                *objs[SLAB_MAG_ROUNDS];
+};
+
 
 /* Cache for caches. Pre-allocated to prevent the chicken and egg problem. */
 static struct slab_cache slab_cache_cache;
@@ -87,67 +117,175 @@ static struct slab_cache slab_cache_cache;
 static struct slab_cache *slab_slabctl_cache;
 /* Cache for external buffer control data */
 static struct slab_cache *slab_bufctl_cache;
+/* Cache for the magazines */
+static struct slab_cache *slab_magazine_cache;
 
+/* List of all the slab caches */
+static struct list_link slab_caches = { &slab_caches, &slab_caches };
 
-static void *bufctl_hash_put(struct slab_cache *cache, struct bufctl *bufctl,
-        int loadcheck)
+/* Slab frames order */
+static unsigned int slab_order(size_t size)
 {
-    if (cache->hload == 0)
+    return fnzb(next_pow2(size >> SLAB_UNIT_BITS));
+}
+
+
+/*
+ * Allocate a bufctl hash table.
+ * Big tables are taken directly from the frame allocator, this prevents
+ * the resize of a large objects cache from recursing in the same cache.
+ */
+static struct htable_link **bufctl_table_alloc(size_t hsize)
+{
+    struct htable_link **htable;
+    size_t size = hsize * sizeof(struct htable_link *);
+
+    if (size <= SLAB_SMALL_MAX)
+        htable = kmalloc(size, 0);
+    else
     {
-        cache->hsize = 32;  // FIXME TODO
-        cache->htable = kmalloc(cache->hsize *
-                                sizeof(struct htable_link *), 0);
-        if (!cache->htable)
-            return NULL;
-        htable_init(cache->htable, fnzb(cache->hsize));
+        htable = frame_alloc(fnzb(size >> SLAB_UNIT_BITS), ZONE_LOW);
+        if (htable)
+            htable = phys_to_virt(htable);
     }
+    if (htable)
+        htable_init(htable, fnzb(hsize));
+    return htable;
+}
+
+static void bufctl_table_free(struct htable_link **htable, size_t hsize)
+{
+    size_t size = hsize * sizeof(struct htable_link *);
+
+    if (size <= SLAB_SMALL_MAX)
+        kfree(htable, size);
+    else
+        frame_free(virt_to_phys(htable), fnzb(size >> SLAB_UNIT_BITS));
+}
 
-#if 0
-    if (loadcheck && (cache->hload == 0 || (float)cache->hload/cache->hsize >= 0.75f))
+/*
+ * Starts a hash table resize.
+ * The current table becomes the old one, its entries are incrementally
+ * moved to the new table by the subsequent hash operations.
+ */
+static int bufctl_hash_resize(struct slab_cache *cache, size_t hsize)
+{
+    struct htable_link **htable;
+
+    htable = bufctl_table_alloc(hsize);
+    if (!htable)
+        return -1;
+    cache->htable_old = cache->htable;
+    cache->hsize_old = cache->hsize;
+    cache->hrehash = 0;
+    cache->htable = htable;
+    cache->hsize = hsize;
+    return 0;
+}
+
+/*
+ * Moves a few old table buckets into the new table.
+ * Amortizes the rehash cost over the hash table operations.
+ */
+static void bufctl_hash_rehash(struct slab_cache *cache)
+{
+    int i;
+    struct htable_link *link;
+    struct bufctl *bctl;
+
+    for (i = 0; i < SLAB_REHASH_STEP && cache->htable_old; i++)
+    {
+        while ((link = cache->htable_old[cache->hrehash]) != NULL)
+        {
+            htable_delete(link);
+            bctl = struct_ptr(link, struct bufctl, hlink);
+            htable_insert(cache->htable, link, (uintptr_t)bctl->buf,
+                    fnzb(cache->hsize));
+        }
+        if (++cache->hrehash == cache->hsize_old)
+        {
+            bufctl_table_free(cache->htable_old, cache->hsize_old);
+            cache->htable_old = NULL;
+            cache->hsize_old = 0;
+        }
+    }
+}
+
+static struct htable_link *bufctl_hash_lookup(struct htable_link **htable,
+        size_t hsize, void *obj)
+{
+    struct htable_link *link;
+
+    link = htable_lookup(htable, (uintptr_t)obj, fnzb(hsize));
+    while (link != NULL)
     {
-        if (bufctl_hash_resize(cache, 1) < 0 && cache->hload == 0)
+        if (struct_ptr(link, struct bufctl, hlink)->buf == obj)
+            break;
+        link = link->next;
+    }
+    return link;
+}
+
+static void *bufctl_hash_put(struct slab_cache *cache, struct bufctl *bufctl)
+{
+    if (!cache->htable)
+    {
+        cache->htable = bufctl_table_alloc(SLAB_HASH_MIN);
+        if (!cache->htable)
             return NULL;
+        cache->hsize = SLAB_HASH_MIN;
+    }
+    else if (!cache->htable_old && cache->hload >= cache->hsize)
+    {
+        /* Load factor reached 1. On failure go on with the current table */
+        (void)bufctl_hash_resize(cache, cache->hsize << 1);
     }
-#endif
+    bufctl_hash_rehash(cache);
 
     htable_insert(cache->htable, &bufctl->hlink, (uintptr_t)bufctl->buf, 
             fnzb(cache->hsize));
-    if (bufctl->hlink.next == NULL)
-        cache->hload++; /* added to an empty slot */
+    cache->hload++;
     return bufctl->buf;
 }
 
 static struct bufctl *bufctl_hash_get(struct slab_cache *cache, void *obj)
 {
     struct htable_link *link;
-    struct bufctl *bctl;
 
     if (!cache->htable)
         return NULL;
 
-    link = htable_lookup(cache->htable, (uintptr_t)obj,
-            fnzb(cache->hsize));
+    bufctl_hash_rehash(cache);
 
-    /* find the correct link */
-    while (link != NULL)
-    {
-        bctl = struct_ptr(link, struct bufctl, hlink);
-        if (bctl->buf == obj)
-            break;
-        link = link->next;
-    }
+    link = bufctl_hash_lookup(cache->htable, cache->hsize, obj);
+    if (!link && cache->htable_old)
+        link = bufctl_hash_lookup(cache->htable_old, cache->hsize_old, obj);
     if (!link)
         return NULL;
 
     htable_delete(link);
+    cache->hload--;
     if (cache->hload == 0)
     {
-        size_t size = cache->hsize * sizeof(struct htable_link *);
-        kfree(cache->htable, size);
+        if (cache->htable_old)
+            bufctl_table_free(cache->htable_old, cache->hsize_old);
+        bufctl_table_free(cache->htable, cache->hsize);
+        cache->htable_old = NULL;
+        cache->hsize_old = 0;
         cache->htable = NULL;
         cache->hsize = 0;
     }
-    return bctl;
+    else if (!cache->htable_old && !cache->reaping &&
+             cache->hsize > SLAB_HASH_MIN &&
+             cache->hload < (cache->hsize >> 2))
+    {
+        /*
+         * Load factor fell below 1/4. Not while reaping, the shrinker
+         * must not allocate frames.
+         */
+        (void)bufctl_hash_resize(cache, cache->hsize >> 1);
+    }
+    return struct_ptr(link, struct bufctl, hlink);
 }
 
 /* 
@@ -180,6 +318,7 @@ static void slab_space_free(struct slabctl* slab, size_t size)
     void *data = slab->data;
     void *obj;
     unsigned int order;
+    uintptr_t base;
 
     for (i = 0, obj = data; i < cache->slab_objs; 
          i++, obj = (char *)obj+cache->objsize)
@@ -197,8 +336,10 @@ static void slab_space_free(struct slabctl* slab, size_t size)
     if (!(cache->flags & SLAB_EMBED_SLABCTL))
         slab_cache_free(slab_slabctl_cache, slab);
 
-    order = size >> (1+SLAB_UNIT_BITS); 
-    frame_free(virt_to_phys(data), order);
+    /* The colour offset is always less than the slab unit */
+    base = ALIGN_DOWN((uintptr_t)data, SLAB_UNIT_SIZE);
+    order = slab_order(size);
+    frame_free(virt_to_phys((void *)base), order);
 }
 
 static struct slabctl *slab_space_alloc(struct slab_cache *cache, int flags)
@@ -212,7 +353,7 @@ static struct slabctl *slab_space_alloc(struct slab_cache *cache, int flags)
     unsigned int order;
     
     size = ALIGN_UP(cache->slab_objs*cache->objsize, SLAB_UNIT_SIZE);
-    order = size >> (1+SLAB_UNIT_BITS);
+    order = slab_order(size);
     data = frame_alloc(order, ZONE_LOW);
     if (!data)
         return NULL;
@@ -232,13 +373,22 @@ static struct slabctl *slab_space_alloc(struct slab_cache *cache, int flags)
         }
     }
     
-    slab->data = data;
+    /*
+     * Shift the first object by the next colour offset. Consecutive slabs
+     * start at different offsets so that the objects with the same index
+     * don't compete for the same cache lines.
+     */
+    slab->data = (char *)data + cache->colour_next;
+    cache->colour_next += cache->colour_off;
+    if (cache->colour_next > cache->colour_max)
+        cache->colour_next = 0;
+
     slab->inuse = cache->slab_objs; /* released by bufctl_list_put */
     slab->cache = cache;
     slab->bctls = NULL;
     list_init(&slab->link);
         
-    for (i = 0, obj = data; i < cache->slab_objs; 
+    for (i = 0, obj = slab->data; i < cache->slab_objs; 
          i++, obj = (char *)obj+cache->objsize)
     {
         if (cache->flags & SLAB_EMBED_BUFCTL)
@@ -268,22 +418,37 @@ static struct slabctl *slab_space_alloc(struct slab_cache *cache, int flags)
 }
 
 
-void *slab_cache_alloc(struct slab_cache *cache, int flags)
+/*
+ * The slab being updated is out of the cache lists while new slabs or hash
+ * tables are allocated. The allocation may reclaim memory, thus the cache
+ * is marked busy to be skipped by the shrinker.
+ */
+static void *slab_buf_alloc(struct slab_cache *cache, int flags)
 {
     void *obj = NULL;
     struct slabctl *slab;
     struct bufctl *bctl;
 
+    cache->busy++;
     if (!list_empty(&cache->slabs_part))
     {
         slab = list_container(cache->slabs_part.next, struct slabctl, link);
         list_delete(&slab->link);
     }
+    else if (!list_empty(&cache->slabs_free))
+    {
+        slab = list_container(cache->slabs_free.next, struct slabctl, link);
+        list_delete(&slab->link);
+        cache->slabs_nfree--;
+    }
     else
     {
         slab = slab_space_alloc(cache, flags);
         if (!slab)
+        {
+            cache->busy--;
             return NULL;
+        }
     }
 
     bctl = bufctl_list_get(slab);
@@ -293,27 +458,30 @@ void *slab_cache_alloc(struct slab_cache *cache, int flags)
     }
     else
     {
-        obj = bufctl_hash_put(cache, bctl, 1);
+        obj = bufctl_hash_put(cache, bctl);
         if (!obj)
-        {
             bufctl_list_put(slab, bctl);
-            return NULL;
-        }
     }
 
-    if (cache->slab_objs - slab->inuse)
+    if (slab->inuse == 0)
+    {
+        /* The hash insertion failed on an empty slab */
+        list_insert_after(&cache->slabs_free, &slab->link);
+        cache->slabs_nfree++;
+    }
+    else if (cache->slab_objs - slab->inuse)
         list_insert_after(&cache->slabs_part, &slab->link);
     else
         list_insert_after(&cache->slabs_full, &slab->link);
 
+    cache->busy--;
     return obj;
 }
 
-void slab_cache_free(struct slab_cache *cache, void *obj)
+static void slab_buf_free(struct slab_cache *cache, void *obj)
 {
     struct slabctl *slab;
     struct bufctl *bctl;
-    size_t size = ALIGN_UP(cache->slab_objs*cache->objsize, SLAB_UNIT_SIZE);
 
     if (cache->flags & SLAB_EMBED_BUFCTL)
     {
@@ -322,7 +490,9 @@ void slab_cache_free(struct slab_cache *cache, void *obj)
     }
     else
     {
+        cache->busy++;
         bctl = bufctl_hash_get(cache, obj);
+        cache->busy--;
         if (!bctl)
             return;
         slab = bctl->slab;
@@ -331,8 +501,10 @@ void slab_cache_free(struct slab_cache *cache, void *obj)
 
     if (slab->inuse == 0)
     {
+        /* Retained until reaped */
         list_delete(&slab->link);
-        slab_space_free(slab, size);
+        list_insert_after(&cache->slabs_free, &slab->link);
+        cache->slabs_nfree++;
     }
     else if (slab->inuse == cache->slab_objs-1)
     {
@@ -341,6 +513,310 @@ void slab_cache_free(struct slab_cache *cache, void *obj)
     }
 }
 
+/*
+ * Returns all the magazine rounds to the slab layer.
+ */
+static void slab_magazine_drain(struct slab_cache *cache,
+        struct slab_magazine *mag)
+{
+    while (mag->rounds > 0)
+        slab_buf_free(cache, mag->objs[--mag->rounds]);
+}
+
+/*
+ * Get an empty magazine, from the depot if possible.
+ */
+static struct slab_magazine *slab_magazine_get(struct slab_cache *cache)
+{
+    struct slab_magazine *mag;
+
+    if (!list_empty(&cache->depot_empty))
+    {
+        mag = list_container(cache->depot_empty.next,
+                struct slab_magazine, link);
+        list_delete(&mag->link);
+    }
+    else
+    {
+        mag = slab_cache_alloc(slab_magazine_cache, 0);
+        if (mag)
+        {
+            list_init(&mag->link);
+            mag->rounds = 0;
+        }
+    }
+    return mag;
+}
+
+/*
+ * Give back a full magazine to the depot. If the depot already holds
+ * enough full magazines the rounds are returned to the slabs.
+ */
+static void slab_magazine_put(struct slab_cache *cache,
+        struct slab_magazine *mag)
+{
+    if (cache->depot_nfull < SLAB_DEPOT_MAX)
+    {
+        list_insert_after(&cache->depot_full, &mag->link);
+        cache->depot_nfull++;
+    }
+    else
+    {
+        slab_magazine_drain(cache, mag);
+        list_insert_after(&cache->depot_empty, &mag->link);
+    }
+}
+
+static void *slab_obj_alloc(struct slab_cache *cache, int flags)
+{
+    struct slab_magazine *mag;
+
+    if (cache->flags & SLAB_NO_MAGAZINE)
+        return slab_buf_alloc(cache, flags);
+
+    if (!cache->loaded || cache->loaded->rounds == 0)
+    {
+        if (cache->previous && cache->previous->rounds > 0)
+        {
+            mag = cache->loaded;
+            cache->loaded = cache->previous;
+            cache->previous = mag;
+        }
+        else if (!list_empty(&cache->depot_full))
+        {
+            /* Exchange the previous (empty) with a full one */
+            mag = list_container(cache->depot_full.next,
+                    struct slab_magazine, link);
+            list_delete(&mag->link);
+            cache->depot_nfull--;
+            if (cache->previous)
+                list_insert_after(&cache->depot_empty,
+                        &cache->previous->link);
+            cache->previous = cache->loaded;
+            cache->loaded = mag;
+        }
+        else
+        {
+            cache->alloc_misses++;
+            return slab_buf_alloc(cache, flags);
+        }
+    }
+
+    cache->alloc_hits++;
+    mag = cache->loaded;
+    return mag->objs[--mag->rounds];
+}
+
+static void slab_obj_free(struct slab_cache *cache, void *obj)
+{
+    struct slab_magazine *mag;
+
+    if (cache->flags & SLAB_NO_MAGAZINE)
+    {
+        slab_buf_free(cache, obj);
+        return;
+    }
+
+    if (!cache->loaded || cache->loaded->rounds == SLAB_MAG_ROUNDS)
+    {
+        if (cache->previous && cache->previous->rounds == 0)
+        {
+            mag = cache->loaded;
+            cache->loaded = cache->previous;
+            cache->previous = mag;
+        }
+        else if ((mag = slab_magazine_get(cache)) != NULL)
+        {
+            /* Exchange the previous (full) with an empty one */
+            if (cache->previous)
+                slab_magazine_put(cache, cache->previous);
+            cache->previous = cache->loaded;
+            cache->loaded = mag;
+        }
+        else
+        {
+            cache->free_misses++;
+            slab_buf_free(cache, obj);
+            return;
+        }
+    }
+
+    cache->free_hits++;
+    mag = cache->loaded;
+    mag->objs[mag->rounds++] = obj;
+}
+
+void *slab_cache_alloc(struct slab_cache *cache, int flags)
+{
+    void *obj;
+
+    obj = slab_obj_alloc(cache, flags);
+    if (obj)
+        cache->allocs++;
+    else
+        cache->failed++;
+    return obj;
+}
+
+void slab_cache_free(struct slab_cache *cache, void *obj)
+{
+    cache->frees++;
+    slab_obj_free(cache, obj);
+}
+
+void slab_cache_flush(struct slab_cache *cache)
+{
+    struct slab_magazine *mag;
+
+    if (cache->loaded)
+        list_insert_after(&cache->depot_full, &cache->loaded->link);
+    if (cache->previous)
+        list_insert_after(&cache->depot_full, &cache->previous->link);
+    cache->loaded = NULL;
+    cache->previous = NULL;
+    cache->depot_nfull = 0;
+
+    list_merge(&cache->depot_full, &cache->depot_empty);
+    list_delete(&cache->depot_empty);
+    while (!list_empty(&cache->depot_full))
+    {
+        mag = list_container(cache->depot_full.next,
+                struct slab_magazine, link);
+        list_delete(&mag->link);
+        slab_magazine_drain(cache, mag);
+        slab_cache_free(slab_magazine_cache, mag);
+    }
+}
+
+void slab_cache_reserve(struct slab_cache *cache, unsigned int nslabs)
+{
+    cache->slabs_reserve = nslabs;
+}
+
+size_t slab_cache_reap(struct slab_cache *cache)
+{
+    struct slab_magazine *mag;
+    struct slabctl *slab;
+    size_t size, count = 0;
+
+    cache->busy++;
+    cache->reaping = 1;
+
+    /* Give back the depot magazines content to the slabs */
+    while (!list_empty(&cache->depot_full))
+    {
+        mag = list_container(cache->depot_full.next,
+                struct slab_magazine, link);
+        list_delete(&mag->link);
+        slab_magazine_drain(cache, mag);
+        list_insert_after(&cache->depot_empty, &mag->link);
+    }
+    cache->depot_nfull = 0;
+    while (!list_empty(&cache->depot_empty))
+    {
+        mag = list_container(cache->depot_empty.next,
+                struct slab_magazine, link);
+        list_delete(&mag->link);
+        slab_cache_free(slab_magazine_cache, mag);
+    }
+
+    size = ALIGN_UP(cache->slab_objs*cache->objsize, SLAB_UNIT_SIZE);
+    while (cache->slabs_nfree > cache->slabs_reserve)
+    {
+        slab = list_container(cache->slabs_free.next, struct slabctl, link);
+        list_delete(&slab->link);
+        cache->slabs_nfree--;
+        slab_space_free(slab, size);
+        count += (1 << slab_order(size));
+    }
+
+    cache->reaping = 0;
+    cache->busy--;
+    return count;
+}
+
+/*
+ * Slab subsystem shrinker.
+ * Caches are reaped in turn until enough frames are released, the busy
+ * ones are skipped: the reclaim has been triggered by their own update.
+ * The magazines cache is the last one, it receives the reaped magazines.
+ */
+static size_t slab_shrink(struct shrinker *shrinker, size_t count)
+{
+    struct list_link *link;
+    struct slab_cache *cache;
+    size_t freed = 0;
+
+    for (link = slab_caches.next; link != &slab_caches && freed < count;
+         link = link->next)
+    {
+        cache = list_container(link, struct slab_cache, link);
+        if (!cache->busy)
+            freed += slab_cache_reap(cache);
+    }
+    if (!slab_magazine_cache->busy)
+        freed += slab_cache_reap(slab_magazine_cache);
+    return freed;
+}
+
+static struct shrinker slab_shrinker = { .shrink = slab_shrink };
+
+void slab_cache_dump(struct slab_cache *cache)
+{
+    kprintf("%s: objsize=%u, alloc=%u/%u, free=%u/%u, depot=%u\n",
+            cache->name, cache->objsize,
+            cache->alloc_hits, cache->alloc_misses,
+            cache->free_hits, cache->free_misses,
+            cache->depot_nfull);
+}
+
+static unsigned int slab_list_count(struct list_link *list)
+{
+    struct list_link *link;
+    unsigned int n = 0;
+
+    for (link = list->next; link != list; link = link->next)
+        n++;
+    return n;
+}
+
+/*
+ * The wasted bytes are the unused slabs tail, the objects padding and
+ * the bytes not used by the variable size requests.
+ */
+int slab_stat(struct kmem_cache_stat *buf, int count)
+{
+    struct list_link *link;
+    struct slab_cache *cache;
+    struct kmem_cache_stat *st;
+    size_t slabsize;
+    int n = 0;
+
+    for (link = slab_caches.next; link != &slab_caches && n < count;
+         link = link->next)
+    {
+        cache = list_container(link, struct slab_cache, link);
+        st = &buf[n++];
+        strncpy(st->name, cache->name, KMEM_NAME_MAX - 1);
+        st->name[KMEM_NAME_MAX - 1] = '\0';
+        st->objsize = cache->objsize;
+        st->inuse = cache->allocs - cache->frees;
+        st->slab_objs = cache->slab_objs;
+        st->slabs_full = slab_list_count(&cache->slabs_full);
+        st->slabs_part = slab_list_count(&cache->slabs_part);
+        st->slabs_free = cache->slabs_nfree;
+        st->allocs = cache->allocs;
+        st->frees = cache->frees;
+        st->failed = cache->failed;
+        slabsize = ALIGN_UP(cache->slab_objs*cache->objsize, SLAB_UNIT_SIZE);
+        st->wasted = (slabsize - cache->slab_objs*cache->objsize) *
+            (st->slabs_full + st->slabs_part + st->slabs_free) +
+            (cache->objsize - cache->reqsize) * st->inuse +
+            cache->req_wasted;
+    }
+    return n;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 
 void slab_cache_init(struct slab_cache *cache, const char *name, 
@@ -355,16 +831,26 @@ void slab_cache_init(struct slab_cache *cache, const char *name,
     memset(cache, 0, sizeof(*cache));
     cache->name = name;
     cache->objsize = ALIGN_UP(objsize, align);
+    cache->reqsize = objsize;
     cache->ctor = ctor;
     cache->dtor = dtor;
     cache->flags = flags;
 
     list_init(&cache->slabs_full); 
     list_init(&cache->slabs_part);
+    list_init(&cache->slabs_free);
+    list_init(&cache->depot_full);
+    list_init(&cache->depot_empty);
+    cache->slabs_reserve = SLAB_RESERVE;
 
     cache->htable = NULL;
     cache->hsize = 0;
     cache->hload = 0;
+    cache->htable_old = NULL;
+    cache->hsize_old = 0;
+    cache->hrehash = 0;
+
+    list_insert_before(&slab_caches, &cache->link);
 
     if (cache->objsize <= SLAB_SMALL_MAX)
     {
@@ -408,6 +894,24 @@ void slab_cache_init(struct slab_cache *cache, const char *name,
     }
     else
         cache->slab_objs = slabsize / cache->objsize;
+
+    /*
+     * Slab colouring.
+     * The unused space at the slab tail is spent to shift the first object
+     * of each new slab by a multiple of the colour step.
+     */
+    cache->colour_off = MAX(align, SLAB_COLOUR_ALIGN);
+    cache->colour_next = 0;
+    cache->colour_max = 0;
+    if (!(flags & SLAB_NO_COLOUR))
+    {
+        slabsize = ALIGN_UP(cache->slab_objs*cache->objsize, SLAB_UNIT_SIZE);
+        if (cache->flags & SLAB_EMBED_SLABCTL)
+            slabsize -= sizeof(struct slabctl);
+        wasted = MIN(slabsize - cache->slab_objs*cache->objsize,
+                     SLAB_UNIT_SIZE - 1);
+        cache->colour_max = wasted - (wasted % cache->colour_off);
+    }
 }
 
 void slab_cache_deinit(struct slab_cache *cache)
@@ -415,6 +919,8 @@ void slab_cache_deinit(struct slab_cache *cache)
     struct slabctl *slab;
     size_t size;
  
+    slab_cache_flush(cache);
+
     size = ALIGN_UP(cache->slab_objs*cache->objsize, SLAB_UNIT_SIZE);
     while (!list_empty(&cache->slabs_part))
     {
@@ -424,10 +930,21 @@ void slab_cache_deinit(struct slab_cache *cache)
     }
     while (!list_empty(&cache->slabs_full))
     {
-        slab = list_container(cache->slabs_part.next, struct slabctl, link);
+        slab = list_container(cache->slabs_full.next, struct slabctl, link);
         list_delete(&slab->link);
         slab_space_free(slab, size);
     }
+    while (!list_empty(&cache->slabs_free))
+    {
+        slab = list_container(cache->slabs_free.next, struct slabctl, link);
+        list_delete(&slab->link);
+        slab_space_free(slab, size);
+    }
+    list_delete(&cache->link);
+    if (cache->htable_old)
+        bufctl_table_free(cache->htable_old, cache->hsize_old);
+    if (cache->htable)
+        bufctl_table_free(cache->htable, cache->hsize);
     memset(cache, 0, sizeof(struct slab_cache));
 }
 
@@ -453,18 +970,27 @@ void slab_init(void)
 {
     /* Initialize the caches cache */
     slab_cache_init(&slab_cache_cache, "slab_cache_cache",
-            sizeof(slab_cache_cache), sizeof(void *), 0,
+            sizeof(slab_cache_cache), sizeof(void *), SLAB_NO_MAGAZINE,
             NULL, NULL);
 
     /* Create a cache for slabs */
     slab_slabctl_cache = slab_cache_create("slab_slabctl_cache",
-            sizeof(struct slabctl), 0, 0, NULL, NULL);
+            sizeof(struct slabctl), 0, SLAB_NO_MAGAZINE, NULL, NULL);
     if (!slab_slabctl_cache)
         panic("slab_slabctl_cache creation error");
 
     /* Create a cache for bufctl */
     slab_bufctl_cache = slab_cache_create("slab_bufctl_cache",
-            sizeof(struct bufctl), 0, 0, NULL, NULL);
+            sizeof(struct bufctl), 0, SLAB_NO_MAGAZINE, NULL, NULL);
     if (!slab_bufctl_cache)
         panic("slab_bufctl_cache creation error");
+
+    /* Create a cache for magazines */
+    slab_magazine_cache = slab_cache_create("slab_magazine_cache",
+            sizeof(struct slab_magazine), 0, SLAB_NO_MAGAZINE, NULL, NULL);
+    if (!slab_magazine_cache)
+        panic("slab_magazine_cache creation error");
+
+    /* Give back empty slabs under memory pressure */
+    shrinker_register(&slab_shrinker);
 }
@@ -22,7 +22,16 @@
 
 #include "list.h"
 #include <sys/types.h>  /* size_t */
+#include <sys/kmem.h>
 
+struct slab_magazine;
+
+/*
+ * Cache creation flags.
+ * Lower bits are reserved for the slab allocator private flags.
+ */
+#define SLAB_NO_COLOUR      (1 << 8)    /**< Don't colour the slabs */
+#define SLAB_NO_MAGAZINE    (1 << 9)    /**< Bypass the magazine layer */
 
 /** Slab cache structure */
 struct slab_cache 
@@ -30,14 +39,42 @@ struct slab_cache
     const char          *name;          /**< Cache name string  */
     unsigned int        flags;          /**< Cache flags */
     size_t              objsize;        /**< Single object size */
+    size_t              reqsize;        /**< Object size requested by user */
     unsigned int        slab_objs;      /**< Objects per slab */
     struct list_link    slabs_full;     /**< List of full slabs */
     struct list_link    slabs_part;     /**< List of partial slabs */
+    struct list_link    slabs_free;     /**< List of empty slabs */
+    unsigned int        slabs_nfree;    /**< Number of empty slabs */
+    unsigned int        slabs_reserve;  /**< Empty slabs kept when reaping */
+    unsigned int        busy;           /**< Slab lists update in progress,
+                                             the shrinker skips the cache */
+    int                 reaping;        /**< Reap in progress */
+    struct list_link    link;           /**< Global caches list link */
+    size_t              colour_off;     /**< Slab colour offset step */
+    size_t              colour_max;     /**< Maximum slab colour offset */
+    size_t              colour_next;    /**< Colour of the next new slab */
     void (*ctor)(void *);               /**< Object constructor */
     void (*dtor)(void *);               /**< Object destructor */
     struct htable_link  **htable;       /**< Hash table */
     size_t              hload;          /**< Hash table load */
     size_t              hsize;          /**< Hash table size */
+    struct htable_link  **htable_old;   /**< Hash table being rehashed */
+    size_t              hsize_old;      /**< Old hash table size */
+    size_t              hrehash;        /**< Next old bucket to rehash */
+    struct slab_magazine *loaded;       /**< Currently loaded magazine */
+    struct slab_magazine *previous;     /**< Previously loaded magazine */
+    struct list_link    depot_full;     /**< Depot full magazines list */
+    struct list_link    depot_empty;    /**< Depot empty magazines list */
+    unsigned int        depot_nfull;    /**< Depot full magazines count */
+    unsigned long       alloc_hits;     /**< Allocs served by magazines */
+    unsigned long       alloc_misses;   /**< Allocs served by slabs */
+    unsigned long       free_hits;      /**< Frees absorbed by magazines */
+    unsigned long       free_misses;    /**< Frees returned to slabs */
+    unsigned long       allocs;         /**< Successful allocations */
+    unsigned long       frees;          /**< Released objects */
+    unsigned long       failed;         /**< Failed allocations */
+    size_t              req_wasted;     /**< Bytes not used by variable
+                                             size requests (e.g. kmalloc) */
 };
 
 void slab_init(void);
@@ -57,5 +94,45 @@ void slab_cache_deinit(struct slab_cache *cache);
 void *slab_cache_alloc(struct slab_cache *cache, int flags);
 void slab_cache_free(struct slab_cache *cache, void *ptr);
 
+/**
+ * Set the number of empty slabs retained as working set when reaping.
+ *
+ * @param cache     Slab cache.
+ * @param nslabs    Number of empty slabs to keep.
+ */
+void slab_cache_reserve(struct slab_cache *cache, unsigned int nslabs);
+
+/**
+ * Release the depot magazines and the empty slabs exceeding the
+ * cache working set reserve.
+ *
+ * @param cache Slab cache.
+ * @return      Number of frames returned to the frame allocator.
+ */
+size_t slab_cache_reap(struct slab_cache *cache);
+
+/**
+ * Returns all the objects cached in the magazine layer to the slabs.
+ *
+ * @param cache Slab cache.
+ */
+void slab_cache_flush(struct slab_cache *cache);
+
+/**
+ * Prints the slab cache usage and magazine layer counters.
+ *
+ * @param cache Slab cache.
+ */
+void slab_cache_dump(struct slab_cache *cache);
+
+/**
+ * Get a snapshot of the registered slab caches counters.
+ *
+ * @param buf   Records buffer.
+ * @param count Number of records in the buffer.
+ * @return      Number of records stored in the buffer.
+ */
+int slab_stat(struct kmem_cache_stat *buf, int count);
+
 
 #endif /* _BEEOS_MM_SLAB_H_ */
@@ -1,4 +1,6 @@
 local_sources := buddy.c \
 				 frame.c \
 				 slab.c \
-				 zone.c
+				 zone.c \
+				 vma.c \
+				 pcache.c
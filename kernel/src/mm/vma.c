@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "vma.h"
+#include "slab.h"
+#include "fs/vfs.h"
+#include "util.h"
+#include "arch/x86/paging.h"
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+
+static struct slab_cache vma_cache;
+
+#define vma_entry(l) list_container(l, struct vma, link)
+
+void vma_init(void)
+{
+    slab_cache_init(&vma_cache, "vma-cache", sizeof(struct vma), 0, 0,
+            NULL, NULL);
+}
+
+struct vma *vma_create(struct list_link *vmas, uintptr_t start,
+        uintptr_t end, int flags)
+{
+    struct list_link *l;
+    struct vma *vma, *curr;
+
+    /* Find the first area after the new one */
+    for (l = vmas->next; l != vmas; l = l->next) {
+        curr = vma_entry(l);
+        if (start < curr->end)
+            break;
+    }
+    if (l != vmas && vma_entry(l)->start < end)
+        return NULL;
+    vma = slab_cache_alloc(&vma_cache, 0);
+    if (!vma)
+        return NULL;
+    vma->start = start;
+    vma->end = end;
+    vma->flags = flags;
+    vma->inode = NULL;
+    vma->offset = 0;
+    vma->fend = start;
+    list_insert_before(l, &vma->link);
+    return vma;
+}
+
+void vma_set_file(struct vma *vma, struct inode *inode, off_t offset,
+        uintptr_t fend)
+{
+    if (vma->inode) {
+        vma->inode->mapped--;
+        iput(vma->inode);
+    }
+    vma->inode = idup(inode);
+    inode->mapped++;
+    vma->offset = offset;
+    vma->fend = fend;
+}
+
+int vma_fill(struct vma *vma, uintptr_t addr, size_t size)
+{
+    size_t n = 0;
+
+    if (vma->inode && addr < vma->fend) {
+        n = MIN(size, vma->fend - addr);
+        if (fs_read(vma->inode, (void *)addr, n,
+                    vma->offset + (addr - vma->start)) != (ssize_t)n)
+            return -1;
+    }
+    memset((char *)addr + n, 0, size - n);
+    return 0;
+}
+
+void vma_delete(struct vma *vma)
+{
+    if (vma->inode) {
+        vma->inode->mapped--;
+        iput(vma->inode);
+    }
+    list_delete(&vma->link);
+    slab_cache_free(&vma_cache, vma);
+}
+
+struct vma *vma_find(struct list_link *vmas, uintptr_t addr)
+{
+    struct list_link *l;
+    struct vma *vma;
+
+    for (l = vmas->next; l != vmas; l = l->next) {
+        vma = vma_entry(l);
+        if (addr < vma->start)
+            break;
+        if (addr < vma->end)
+            return vma;
+    }
+    return NULL;
+}
+
+struct vma *vma_find_flags(struct list_link *vmas, int flags)
+{
+    struct list_link *l;
+
+    for (l = vmas->next; l != vmas; l = l->next)
+        if ((vma_entry(l)->flags & flags) == flags)
+            return vma_entry(l);
+    return NULL;
+}
+
+int vma_resize(struct list_link *vmas, struct vma *vma, uintptr_t start,
+        uintptr_t end)
+{
+    if (vma->link.prev != vmas && start < vma_entry(vma->link.prev)->end)
+        return -1;
+    if (vma->link.next != vmas && vma_entry(vma->link.next)->start < end)
+        return -1;
+    vma->start = start;
+    vma->end = end;
+    return 0;
+}
+
+struct vma *vma_split(struct vma *vma, uintptr_t addr)
+{
+    struct vma *upper;
+
+    upper = slab_cache_alloc(&vma_cache, 0);
+    if (!upper)
+        return NULL;
+    *upper = *vma;
+    upper->start = addr;
+    if (upper->inode) {
+        idup(upper->inode);
+        upper->inode->mapped++;
+        upper->offset += addr - vma->start;
+    }
+    vma->end = addr;
+    list_insert_after(&vma->link, &upper->link);
+    return upper;
+}
+
+/*
+ * Split the area containing an address, if the address is within it.
+ */
+static int vma_split_at(struct list_link *vmas, uintptr_t addr, size_t large)
+{
+    struct vma *vma;
+
+    vma = vma_find(vmas, addr);
+    if (!vma || vma->start == addr)
+        return 0;
+    if ((vma->flags & VMA_LARGE) && (addr & (large - 1)))
+        return -EINVAL;
+    return (vma_split(vma, addr) != NULL) ? 0 : -ENOMEM;
+}
+
+int vma_isolate(struct list_link *vmas, uintptr_t start, uintptr_t end,
+        size_t large)
+{
+    int ret;
+
+    if ((ret = vma_split_at(vmas, start, large)) < 0)
+        return ret;
+    return vma_split_at(vmas, end, large);
+}
+
+uintptr_t vma_find_free(struct list_link *vmas, size_t size, size_t align,
+        uintptr_t top)
+{
+    struct list_link *l;
+    struct vma *vma;
+    uintptr_t start, end = top;
+
+    /* Gaps are scanned top down, the page at address zero is never used */
+    for (l = vmas->prev; l != vmas; l = l->prev) {
+        vma = vma_entry(l);
+        if (vma->end < end && end - vma->end >= size) {
+            start = ALIGN_DOWN(end - size, align);
+            if (start >= vma->end)
+                return start;
+        }
+        end = MIN(end, vma->start);
+    }
+    return (end > size) ? ALIGN_DOWN(end - size, align) : 0;
+}
+
+struct vma *vma_stack_expand(struct list_link *vmas, uintptr_t addr)
+{
+    struct list_link *l;
+    struct vma *vma;
+
+    /* First area above the address */
+    for (l = vmas->next; l != vmas; l = l->next)
+        if (addr < vma_entry(l)->start)
+            break;
+    if (l == vmas)
+        return NULL;
+    vma = vma_entry(l);
+    if (!(vma->flags & VMA_STACK) || vma->end - addr > VMA_STACK_MAX)
+        return NULL;
+    if (vma_resize(vmas, vma, addr, vma->end) < 0)
+        return NULL;
+    return vma;
+}
+
+int vma_access(struct list_link *vmas, uintptr_t addr, size_t size,
+        int write)
+{
+    uintptr_t end = addr + size;
+    struct vma *vma;
+
+    if (end < addr)
+        return -1;
+    while (addr < end) {
+        vma = vma_find(vmas, addr);
+        if (!vma)
+            vma = vma_stack_expand(vmas, ALIGN_DOWN(addr, PAGE_SIZE));
+        if (!vma || (write && !(vma->flags & VMA_WRITE)) ||
+            !(vma->flags & (VMA_READ | VMA_WRITE | VMA_EXEC)))
+            return -1;
+        addr = vma->end;
+    }
+    return 0;
+}
+
+int vma_dup(struct list_link *dst, struct list_link *src)
+{
+    struct list_link *l;
+    struct vma *vma, *copy;
+
+    for (l = src->next; l != src; l = l->next) {
+        vma = vma_entry(l);
+        copy = vma_create(dst, vma->start, vma->end, vma->flags);
+        if (!copy) {
+            vma_clear(dst);
+            return -1;
+        }
+        if (vma->inode)
+            vma_set_file(copy, vma->inode, vma->offset, vma->fend);
+    }
+    return 0;
+}
+
+void vma_clear(struct list_link *vmas)
+{
+    while (!list_empty(vmas))
+        vma_delete(vma_entry(vmas->next));
+}
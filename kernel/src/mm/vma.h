@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Process virtual memory areas.
+ * Each process owns a list of non overlapping address ranges, sorted by
+ * address. User pages are mapped on demand only within these ranges.
+ * The pages of a file backed area are populated with the file content on
+ * the first access, anonymous areas pages are zero filled.
+ */
+
+#ifndef _BEEOS_MM_VMA_H_
+#define _BEEOS_MM_VMA_H_
+
+#include "list.h"
+#include <stdint.h>
+#include <sys/types.h>
+
+struct inode;
+
+#define VMA_READ        0x01    /**< Readable area */
+#define VMA_WRITE       0x02    /**< Writeable area */
+#define VMA_EXEC        0x04    /**< Executable area */
+#define VMA_HEAP        0x08    /**< Program break area */
+#define VMA_STACK       0x10    /**< Stack area, grows down on demand */
+#define VMA_LARGE       0x20    /**< Anonymous area, large pages if possible */
+#define VMA_SHARED      0x40    /**< Shared file area, never writeable */
+
+/** Maximum stack area size. */
+#define VMA_STACK_MAX   (8 << 20)
+
+/**
+ * Top of the memory mappings (mmap) space, the mappings are placed top
+ * down below this address. Addresses above it would be returned to the
+ * user as negative (error) syscall return values.
+ */
+#define VMA_MMAP_TOP    0x80000000
+
+/**
+ * Fault around window, in pages (power of two, 1 to disable).
+ * On a file backed area fault all the missing pages of the aligned window
+ * containing the faulting address are populated at once.
+ */
+#define VMA_FAULT_AROUND    4
+
+/** Virtual memory area. */
+struct vma
+{
+    struct list_link    link;   /**< Process areas list link */
+    uintptr_t           start;  /**< Start address (page aligned) */
+    uintptr_t           end;    /**< End address, excluded (page aligned) */
+    int                 flags;  /**< Area flags (e.g. VMA_WRITE) */
+    struct inode        *inode; /**< Backing file, NULL if anonymous */
+    off_t               offset; /**< File offset of the area start */
+    uintptr_t           fend;   /**< End address of the file content */
+};
+
+/**
+ * Initialize the areas descriptors cache.
+ */
+void vma_init(void);
+
+/**
+ * Create a new area and add it to a process areas list.
+ *
+ * @param vmas  Process areas list.
+ * @param start Area start address.
+ * @param end   Area end address.
+ * @param flags Area flags.
+ * @return      The new area, NULL if overlaps another area or if there
+ *              is no memory.
+ */
+struct vma *vma_create(struct list_link *vmas, uintptr_t start,
+        uintptr_t end, int flags);
+
+/**
+ * Back an area with a file.
+ * The content past the file end (e.g. the bss) is zero filled.
+ *
+ * @param vma       Area.
+ * @param inode     File inode (a new reference is taken).
+ * @param offset    File offset of the area start.
+ * @param fend      End address of the file content within the area.
+ */
+void vma_set_file(struct vma *vma, struct inode *inode, off_t offset,
+        uintptr_t fend);
+
+/**
+ * Populate a portion of a mapped area with its content.
+ *
+ * @param vma   Area.
+ * @param addr  Start address (page aligned).
+ * @param size  Size of the portion.
+ * @return      Zero on success, -1 on file read error.
+ */
+int vma_fill(struct vma *vma, uintptr_t addr, size_t size);
+
+/**
+ * Remove an area from its list and release it.
+ *
+ * @param vma   Area.
+ */
+void vma_delete(struct vma *vma);
+
+/**
+ * Find the area containing an address.
+ *
+ * @param vmas  Process areas list.
+ * @param addr  Virtual address.
+ * @return      The area, NULL if the address is not within an area.
+ */
+struct vma *vma_find(struct list_link *vmas, uintptr_t addr);
+
+/**
+ * Find the first area with all the given flags.
+ *
+ * @param vmas  Process areas list.
+ * @param flags Area flags (e.g. VMA_HEAP).
+ * @return      The area, NULL if not found.
+ */
+struct vma *vma_find_flags(struct list_link *vmas, int flags);
+
+/**
+ * Change the boundaries of an area.
+ *
+ * @param vmas  Process areas list.
+ * @param vma   Area.
+ * @param start New start address.
+ * @param end   New end address.
+ * @return      Zero on success, -1 if the area would overlap its
+ *              neighbours.
+ */
+int vma_resize(struct list_link *vmas, struct vma *vma, uintptr_t start,
+        uintptr_t end);
+
+/**
+ * Split an area in two at an address.
+ * The area keeps the lower part, a new area is created for the upper part.
+ *
+ * @param vma   Area.
+ * @param addr  Page aligned address within the area.
+ * @return      The upper part area, NULL if there is no memory.
+ */
+struct vma *vma_split(struct vma *vma, uintptr_t addr);
+
+/**
+ * Split the areas crossing the boundaries of an address range.
+ * Afterwards each area is either within the range or outside of it.
+ * Large pages areas can be split only at large page boundaries.
+ *
+ * @param vmas  Process areas list.
+ * @param start Range start address (page aligned).
+ * @param end   Range end address (page aligned).
+ * @param large Large page size.
+ * @return      Zero on success, -EINVAL if a large pages area would be
+ *              split within a large page, -ENOMEM if there is no memory.
+ */
+int vma_isolate(struct list_link *vmas, uintptr_t start, uintptr_t end,
+        size_t large);
+
+/**
+ * Find a free address range, the highest one below a given address.
+ *
+ * @param vmas  Process areas list.
+ * @param size  Range size (page aligned).
+ * @param align Range start alignment (power of two).
+ * @param top   Range end upper limit.
+ * @return      Range start address, zero if there is no such range.
+ */
+uintptr_t vma_find_free(struct list_link *vmas, size_t size, size_t align,
+        uintptr_t top);
+
+/**
+ * Expand the stack area down to an address.
+ * Fails if the address is not just below a stack area, if the stack
+ * would exceed VMA_STACK_MAX or would overlap the previous area.
+ *
+ * @param vmas  Process areas list.
+ * @param addr  Page aligned virtual address.
+ * @return      The stack area, NULL on failure.
+ */
+struct vma *vma_stack_expand(struct list_link *vmas, uintptr_t addr);
+
+/**
+ * Check that an address range is accessible by the process.
+ * The range must be within the process areas, the stack area is
+ * expanded down to the range start if needed (as on a page fault).
+ *
+ * @param vmas  Process areas list.
+ * @param addr  Range start address.
+ * @param size  Range size.
+ * @param write Non zero if the range is going to be written.
+ * @return      Zero if the range is accessible, -1 otherwise.
+ */
+int vma_access(struct list_link *vmas, uintptr_t addr, size_t size,
+        int write);
+
+/**
+ * Copy the areas of a process.
+ *
+ * @param dst   Destination (empty) areas list.
+ * @param src   Source areas list.
+ * @return      Zero on success, -1 if there is no memory.
+ */
+int vma_dup(struct list_link *dst, struct list_link *src);
+
+/**
+ * Release all the areas of a process.
+ *
+ * @param vmas  Process areas list.
+ */
+void vma_clear(struct list_link *vmas);
+
+#endif /* _BEEOS_MM_VMA_H_ */
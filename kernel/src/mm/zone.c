@@ -29,9 +29,28 @@ void *zone_alloc(struct zone_st *ctx, int order)
     if (!frame)
         return NULL;
     frame->refs++;
+    ctx->free_count -= (1 << order);
+    ctx->busy_count += (1 << order);
     return (ctx->addr + ctx->frame_size*(frame-ctx->buddy.frames));
 }
 
+unsigned int zone_alloc_bulk(struct zone_st *ctx, unsigned int count,
+        void **ptrs)
+{
+    unsigned int i, n;
+    struct frame **frames = (struct frame **)ptrs;
+
+    /* The frames pointers are replaced in place by the frames addresses */
+    n = buddy_alloc_bulk(&ctx->buddy, count, frames);
+    for (i = 0; i < n; i++) {
+        frames[i]->refs++;
+        ptrs[i] = ctx->addr + ctx->frame_size*(frames[i]-ctx->buddy.frames);
+    }
+    ctx->free_count -= n;
+    ctx->busy_count += n;
+    return n;
+}
+
 void zone_free(struct zone_st *ctx, void *ptr, int order)
 {
     int i;
@@ -43,19 +62,63 @@ void zone_free(struct zone_st *ctx, void *ptr, int order)
     {
         frame->refs--;
         if (frame->refs == 0)
+        {
             buddy_free(&ctx->buddy, frame, order);
+            ctx->free_count += (1 << order);
+            ctx->busy_count -= (1 << order);
+        }
+    }
+}
+
+void zone_free_bulk(struct zone_st *ctx, void **ptrs, unsigned int count)
+{
+    unsigned int i, n = 0;
+    struct frame *frame;
+
+    for (i = 0; i < count; i++)
+    {
+        frame = &ctx->buddy.frames[((char *)ptrs[i] - ctx->addr) /
+                                   ctx->frame_size];
+        if (frame->refs > 0 && --frame->refs == 0)
+        {
+            buddy_free(&ctx->buddy, frame, 0);
+            n++;
+        }
     }
+    ctx->free_count += n;
+    ctx->busy_count -= n;
+}
+
+void zone_free_range(struct zone_st *ctx, void *ptr, size_t count)
+{
+    size_t i;
+    struct frame *frame;
+
+    frame = &ctx->buddy.frames[((char *)ptr - ctx->addr) / ctx->frame_size];
+    for (i = 0; i < count; i++)
+        frame[i].refs = 0;
+    buddy_free_range(&ctx->buddy, frame, count);
+    ctx->free_count += count;
+    ctx->busy_count -= count;
 }
 
 int zone_init(struct zone_st *ctx, void *addr, size_t size,
-        size_t frame_size, int flags)
+        size_t frame_size, int flags, struct frame *frames)
 {
+    size_t i;
+
     ctx->addr = addr;
     ctx->size = size;
     ctx->frame_size = frame_size;
     ctx->flags = flags;
     ctx->next = NULL;
-    return buddy_init(&ctx->buddy, size/frame_size, frame_size);
+    /* Initially all the frames are busy, released by the arch code */
+    ctx->free_count = 0;
+    ctx->busy_count = size/frame_size;
+    ctx->free_low = (size/frame_size) >> ZONE_WATERMARK_SHIFT;
+    for (i = 0; i < size/frame_size; i++)
+        frames[i].zone = ctx;
+    return buddy_init(&ctx->buddy, size/frame_size, frame_size, frames);
 }
 
 void zone_dump(struct zone_st *ctx)
@@ -32,6 +32,9 @@
 #define ZONE_HIGH   0
 #define ZONE_LOW    1
 
+/** Free frames watermark, as a fraction (power of two) of the zone */
+#define ZONE_WATERMARK_SHIFT    6
+
 /** Zone descriptor */
 struct zone_st 
 {
@@ -40,8 +43,8 @@ struct zone_st
     size_t      frame_size;     /**< Size of a single frame */
 	size_t      free_count;     /**< Number of free frames */
 	size_t      busy_count;     /**< Number of busy frames */
+	size_t      free_low;       /**< Free frames reclaim watermark */
 	char        flags;          /**< Type of the zone (e.g. ZONE_HIGH) */
-	struct frame_st *frames;    /**< Array of frame structures in this zone */
     struct zone_st *next;       /**< Link to next zone */
 	struct buddy_sys buddy;     /**< Buddy system for the zone */
 };
@@ -54,10 +57,11 @@ struct zone_st
  * @param size          Zone size.
  * @param frame_size    Size of the frame within the zone.
  * @param flags         Zone flags (e.g. ZONE_HIGH).
+ * @param frames        Zone frames descriptors (one for each frame).
  * @return              On error -1 is returned.
  */
 int zone_init(struct zone_st *ctx, void *base, size_t size,
-        size_t frame_size, int flags);
+        size_t frame_size, int flags, struct frame *frames);
 
 /**
  * Allocate a memory segment from a zone.
@@ -70,6 +74,17 @@ int zone_init(struct zone_st *ctx, void *base, size_t size,
  */
 void *zone_alloc(struct zone_st *ctx, int order);
 
+/**
+ * Allocate a number of frames from a zone.
+ *
+ * @param ctx   Zone descriptor structure.
+ * @param count Number of requested frames.
+ * @param ptrs  Array filled with the frames addresses.
+ * @return      Number of allocated frames.
+ */
+unsigned int zone_alloc_bulk(struct zone_st *ctx, unsigned int count,
+        void **ptrs);
+
 /**
  * Free a memory segment from the zone.
  *
@@ -79,6 +94,27 @@ void *zone_alloc(struct zone_st *ctx, int order);
  */
 void zone_free(struct zone_st *ctx, void *ptr, int order);
 
+/**
+ * Free a number of frames (order zero) from the zone.
+ * The zone counters are updated once for the whole batch.
+ *
+ * @param ctx   Zone descriptor structure.
+ * @param ptrs  Frames addresses.
+ * @param count Number of frames.
+ */
+void zone_free_bulk(struct zone_st *ctx, void **ptrs, unsigned int count);
+
+/**
+ * Free a range of frames from the zone.
+ * All the frames in the range must be allocated with a single reference,
+ * as they are when the zone is initialized.
+ *
+ * @param ctx   Zone descriptor structure.
+ * @param ptr   First frame address.
+ * @param count Number of frames.
+ */
+void zone_free_range(struct zone_st *ctx, void *ptr, size_t count);
+
 /**
  * DEBUG function.
  * Dumps the current memory situation on the stdout.
@@ -21,17 +21,89 @@
 #define _BEEOS_PROC_H_
 
 #include "proc/task.h"
+#include "elf.h"
+#include <sched.h>
 
-/* Default process timeslice (milliseconds) */
+/* SCHED_RR tasks timeslice (milliseconds) */
 #define SCHED_TIMESLICE     100
 
+/* Number of fixed scheduling priorities, zero is the highest */
+#define SCHED_PRIOS         32
+
+/* Priority of the fair class tasks, below all the fixed priorities */
+#define SCHED_PRIO_FAIR     SCHED_PRIOS
+
+/* Real-time priorities range, mapped on the fixed priorities in reverse */
+#define SCHED_RT_PRIO_MIN   1
+#define SCHED_RT_PRIO_MAX   SCHED_PRIOS
+
+/* Fair class preemption granularity (milliseconds) */
+#define SCHED_GRANULARITY   20
+
+/* Fair class maximum credit of a waking up task (milliseconds) */
+#define SCHED_WAKEUP_CREDIT 50
+
+/* Nice values range */
+#define NICE_MIN            (-20)
+#define NICE_MAX            19
+
+/** Set to request a scheduler call before returning from the interrupt. */
+extern int need_resched;
+
 extern struct task *current_task;
 
 void scheduler(void);
 
 void scheduler_init(void);
 
-void wakeup(void *ctx);
+/**
+ * Make a task runnable (TASK_RUNNING) and insert it in the run queue.
+ * Waking up an already runnable task has no effect.
+ *
+ * @param task      Task to wake up.
+ */
+void wakeup(struct task *task);
+
+/**
+ * Change the scheduling policy of a task.
+ * If runnable, the task is moved to the run queue of the new class.
+ *
+ * @param task      Target task.
+ * @param policy    Scheduling policy (SCHED_OTHER, SCHED_FIFO or SCHED_RR).
+ * @param rtprio    Real-time priority, ignored for SCHED_OTHER.
+ */
+void sched_setpolicy(struct task *task, int policy, int rtprio);
+
+/**
+ * Real-time priority of a task.
+ *
+ * @param task      Target task.
+ * @return          Real-time priority, zero for SCHED_OTHER tasks.
+ */
+int sched_rtprio(struct task *task);
+
+/**
+ * Scheduler clock tick.
+ * Charges the running time to the current task and eventually requests
+ * its preemption (see need_resched).
+ */
+void sched_tick(void);
+
+/**
+ * Check if the periodic scheduler tick is useless, that is if the current
+ * task is the idle one or the only runnable task.
+ *
+ * @return  Non zero if the tick can be stopped.
+ */
+int sched_nohz_allowed(void);
+
+/**
+ * Change the current task state and remove it from the run queue.
+ * The task keeps running until the next scheduler call.
+ *
+ * @param state     New state (e.g. TASK_SLEEPING).
+ */
+void suspend(int state);
 
 /**
  * Process pending (non masked) signals.
@@ -39,6 +111,44 @@ void wakeup(void *ctx);
 int do_signal(void);
 
 
+/** Program image ready to replace the current process memory. */
+struct exec_image
+{
+    struct inode    *inode;     /**< Executable file. */
+    struct elf_hdr  eh;         /**< Executable ELF header. */
+    void            *ustack;    /**< Arguments and environment copy. */
+};
+
+/**
+ * Prepare a program image.
+ * The arguments and the environment are copied in kernel memory, thus the
+ * image can be loaded in a different address space (see sys_spawn).
+ *
+ * @param img       Image to initialize.
+ * @param path      Executable file path.
+ * @param argv      Program arguments.
+ * @param envp      Program environment.
+ * @return          Zero on success, a negative error number on failure.
+ */
+int exec_prepare(struct exec_image *img, const char *path,
+        const char *argv[], const char *envp[]);
+
+/**
+ * Replace the current process memory with a prepared image.
+ * The image resources are released also on failure.
+ *
+ * @param img       Prepared image.
+ * @return          Zero on success, a negative error number on failure.
+ */
+int exec_load(struct exec_image *img);
+
+/**
+ * Release a prepared image that is not going to be loaded.
+ *
+ * @param img       Prepared image.
+ */
+void exec_release(struct exec_image *img);
+
 /*
  * Start init user-mode process.
  */
@@ -22,10 +22,226 @@
 #include "timer.h"
 #include "kmalloc.h"
 #include "sys.h"
+#include "util.h"
 
 struct task ktask;
 struct task *current_task;
-struct task *ready_queue;
+
+/* Weight of a nice 0 task */
+#define NICE_0_WEIGHT       1024
+
+/* Virtual runtime charged to a nice 0 task for each clock tick */
+#define VRUNTIME_TICK       1024
+
+/*
+ * Fair class weights, indexed by the nice value. Each nice level is worth
+ * about 10% of the CPU time with respect to the next one.
+ */
+static const unsigned int nice_weight[NICE_MAX - NICE_MIN + 1] = {
+    /* -20 */ 88761, 71755, 56483, 46273, 36291,
+    /* -15 */ 29154, 23254, 18705, 14949, 11916,
+    /* -10 */  9548,  7620,  6100,  4904,  3906,
+    /*  -5 */  3121,  2501,  1991,  1586,  1277,
+    /*   0 */  1024,   820,   655,   526,   423,
+    /*   5 */   335,   272,   215,   172,   137,
+    /*  10 */   110,    87,    70,    56,    45,
+    /*  15 */    36,    29,    23,    18,    15,
+};
+
+/*
+ * Run queue.
+ * Runnable real-time tasks (SCHED_FIFO and SCHED_RR), the current one
+ * included, are kept in per priority lists. A bit is set for each non
+ * empty list, thus the highest priority runnable task is found in
+ * constant time.
+ * Tasks of the fair class (SCHED_OTHER) run only when there are no
+ * real-time tasks. They are ordered by virtual runtime, the running
+ * time weighted by the nice value, and the least served one is picked.
+ * The idle task is never queued.
+ */
+static struct runq {
+    unsigned long       bitmap;
+    struct list_link    queue[SCHED_PRIOS];
+    struct rb_tree      fair;
+    unsigned long       min_vruntime;   /* Monotonic fair tasks minimum */
+} runq;
+
+/* Virtual runtimes difference, wrap around safe */
+static inline long vruntime_diff(unsigned long a, unsigned long b)
+{
+    return (long)(a - b);
+}
+
+static int fair_less(const struct rb_node *a, const struct rb_node *b)
+{
+    return vruntime_diff(rb_container(a, struct task, fair)->vruntime,
+                         rb_container(b, struct task, fair)->vruntime) < 0;
+}
+
+static struct task *fair_first(void)
+{
+    struct rb_node *first = rb_first(&runq.fair);
+
+    return (first != NULL) ? rb_container(first, struct task, fair) : NULL;
+}
+
+static void fair_update_min(void)
+{
+    struct task *first = fair_first();
+
+    if (first && vruntime_diff(first->vruntime, runq.min_vruntime) > 0)
+        runq.min_vruntime = first->vruntime;
+}
+
+static int runq_queued(struct task *task)
+{
+    if (task->prio == SCHED_PRIO_FAIR)
+        return rb_linked(&task->fair);
+    return !list_empty(&task->runq);
+}
+
+static void runq_insert(struct task *task)
+{
+    if (task->prio == SCHED_PRIO_FAIR) {
+        rb_insert(&runq.fair, &task->fair, fair_less);
+    } else {
+        list_insert_before(&runq.queue[task->prio], &task->runq);
+        runq.bitmap |= (1UL << task->prio);
+    }
+}
+
+static void runq_delete(struct task *task)
+{
+    if (task->prio == SCHED_PRIO_FAIR) {
+        rb_erase(&runq.fair, &task->fair);
+        fair_update_min();
+    } else {
+        list_delete(&task->runq);
+        if (list_empty(&runq.queue[task->prio]))
+            runq.bitmap &= ~(1UL << task->prio);
+    }
+}
+
+/* Check if a waking up task should preempt the current one */
+static int preempts(struct task *task)
+{
+    struct task *curr = current_task;
+    unsigned long gran;
+
+    if (curr == &ktask)
+        return 1;
+    if (task->prio != curr->prio)
+        return task->prio < curr->prio;
+    if (task->prio != SCHED_PRIO_FAIR)
+        return 0;   /* Same real-time priority, wait for our turn */
+    gran = msecs_to_ticks(SCHED_GRANULARITY) * VRUNTIME_TICK;
+    return vruntime_diff(curr->vruntime, task->vruntime) > (long)gran;
+}
+
+/* Sleepers are credited, but a long sleep is not a CPU reserve */
+static void fair_place(struct task *task)
+{
+    unsigned long credit;
+
+    credit = msecs_to_ticks(SCHED_WAKEUP_CREDIT) * VRUNTIME_TICK;
+    if (vruntime_diff(task->vruntime, runq.min_vruntime - credit) < 0)
+        task->vruntime = runq.min_vruntime - credit;
+}
+
+void wakeup(struct task *task)
+{
+    task->state = TASK_RUNNING;
+    if (task == &ktask || runq_queued(task))
+        return;
+    /* Someone may have to be preempted, the tick is required */
+    timer_nohz_exit();
+    if (task->prio == SCHED_PRIO_FAIR)
+        fair_place(task);
+    runq_insert(task);
+    if (preempts(task))
+        need_resched = 1;
+}
+
+void suspend(int state)
+{
+    struct task *task = current_task;
+
+    task->state = state;
+    if (task != &ktask && runq_queued(task))
+        runq_delete(task);
+}
+
+void sched_setpolicy(struct task *task, int policy, int rtprio)
+{
+    int queued = (task != &ktask && runq_queued(task));
+
+    if (queued)
+        runq_delete(task);
+    task->policy = policy;
+    if (policy == SCHED_FIFO || policy == SCHED_RR)
+        task->prio = SCHED_PRIOS - rtprio;
+    else
+        task->prio = SCHED_PRIO_FAIR;
+    task->counter = msecs_to_ticks(SCHED_TIMESLICE);
+    if (queued) {
+        if (task->prio == SCHED_PRIO_FAIR)
+            fair_place(task);
+        runq_insert(task);
+        /* Let the scheduler evaluate the new priorities */
+        need_resched = 1;
+    }
+}
+
+int sched_rtprio(struct task *task)
+{
+    return (task->prio != SCHED_PRIO_FAIR) ? SCHED_PRIOS - task->prio : 0;
+}
+
+int sched_nohz_allowed(void)
+{
+    struct task *curr = current_task;
+    struct rb_node *node = &curr->fair;
+
+    if (curr == &ktask)
+        return runq.bitmap == 0 && fair_first() == NULL;
+    if (curr->state != TASK_RUNNING)
+        return 0;
+    if (curr->prio == SCHED_PRIO_FAIR)
+        return runq.bitmap == 0 && runq.fair.root == node &&
+               node->left == NULL && node->right == NULL;
+    return runq.bitmap == (1UL << curr->prio) && fair_first() == NULL &&
+           curr->runq.next == curr->runq.prev;
+}
+
+void sched_tick(void)
+{
+    struct task *curr = current_task, *first;
+    unsigned long gran;
+
+    if (curr == &ktask || curr->state != TASK_RUNNING)
+        return;
+
+    if (curr->policy == SCHED_FIFO)
+        return;     /* Runs until it blocks or yields */
+    if (curr->policy == SCHED_RR) {
+        if (curr->counter-- <= 0)
+            need_resched = 1;
+        return;
+    }
+
+    /* The key changes, the task is moved within the tree */
+    rb_erase(&runq.fair, &curr->fair);
+    curr->vruntime += (NICE_0_WEIGHT * VRUNTIME_TICK) /
+                      nice_weight[curr->nice - NICE_MIN];
+    rb_insert(&runq.fair, &curr->fair, fair_less);
+    fair_update_min();
+
+    first = fair_first();
+    gran = msecs_to_ticks(SCHED_GRANULARITY) * VRUNTIME_TICK;
+    if (first != curr &&
+        vruntime_diff(curr->vruntime, first->vruntime) > (long)gran)
+        need_resched = 1;
+}
 
 
 int sigpop(sigset_t *sigpend, sigset_t *sigmask)
@@ -92,31 +308,44 @@ void scheduler(void)
 {
     struct task *curr;
     struct task *next;
-    
+    struct list_link *queue;
+
     curr = current_task;
-    next = list_container(current_task->tasks.next, 
-            struct task, tasks);
 
-    while (next->state != TASK_RUNNING && next != current_task)
-        next = list_container(next->tasks.next, struct task, tasks);
-    
-    if (next == current_task && next->pid != 0)
-    {
+    /*
+     * Round robin between SCHED_RR tasks with the same priority once the
+     * time slice is expired. A preempted task keeps its place.
+     */
+    if (curr->policy == SCHED_RR && curr->counter < 0 &&
+        !list_empty(&curr->runq)) {
+        list_delete(&curr->runq);
+        list_insert_before(&runq.queue[curr->prio], &curr->runq);
+        curr->counter = msecs_to_ticks(SCHED_TIMESLICE);
+    }
+
+    if (runq.bitmap != 0) {
+        queue = &runq.queue[lnzb(runq.bitmap)];
+        next = list_container(queue->next, struct task, runq);
+    } else if ((next = fair_first()) != NULL) {
+        /* Least served fair task */
+    } else {
         /* Nothing to run... run the idle() task */
         ktask.state = TASK_RUNNING;
         next = &ktask;
     }
 
-    current_task = next;
-    task_arch_switch(&curr->arch, &next->arch);
-
-    current_task->counter = msecs_to_ticks(SCHED_TIMESLICE);
+    if (next != curr) {
+        current_task = next;
+        task_arch_switch(&curr->arch, &next->arch);
+    }
 }
 
 void scheduler_init(void)
 {
     int i;
 
+    task_cache_init();
+
     /* Set to zero: uids, gids, pids... */
     memset(&ktask, 0, sizeof(ktask));
     ktask.cwd = NULL;
@@ -127,7 +356,18 @@ void scheduler_init(void)
     list_init(&ktask.children);
     list_init(&ktask.condw);
     list_init(&ktask.timers);
-    task_arch_init(&ktask.arch);
+    list_init(&ktask.vmas);
+    list_init(&ktask.runq);
+    rb_node_init(&ktask.fair);
+    ktask.policy = SCHED_OTHER;
+    ktask.prio = SCHED_PRIO_FAIR;
+    task_arch_init(&ktask.arch, 0);
+
+    for (i = 0; i < SCHED_PRIOS; i++)
+        list_init(&runq.queue[i]);
+    runq.bitmap = 0;
+    rb_tree_init(&runq.fair);
+    runq.min_vruntime = 0;
 
     (void)sigemptyset(&ktask.sigmask);
     (void)sigemptyset(&ktask.sigpend);
@@ -156,8 +396,8 @@ void task_dump(struct task *t)
             state = 'U';
             break;
     }
-    kprintf("<pid=%d, ppid=%d, pgid=%d, state=%c)>",
-              t->pid, t->pptr->pid, t->pgid, state);
+    kprintf("<pid=%d, ppid=%d, pgid=%d, state=%c, faults=%u)>",
+              t->pid, t->pptr->pid, t->pgid, state, t->faults);
 }
 
 
@@ -21,16 +21,62 @@
 #include "proc.h"
 #include "fs/vfs.h"
 #include "timer.h"
-#include "kmalloc.h"
+#include "mm/slab.h"
+#include "mm/vma.h"
 #include "panic.h"
 #include <string.h>
 
-int task_init(struct task *task)
+static struct slab_cache task_cache;
+
+/*
+ * Task objects constructor.
+ * List heads and the children exit condition are initialized once per slab.
+ * A task is released only after being reaped, at that point its links have
+ * been removed (and reinitialized) by list_delete and the timers, conditional
+ * wait and memory areas lists are empty, thus the object is back in the
+ * constructed state.
+ */
+static void task_ctor(void *obj)
+{
+    struct task *task = (struct task *)obj;
+
+    memset(task, 0, sizeof(*task));
+    list_init(&task->tasks);
+    list_init(&task->children);
+    list_init(&task->sibling);
+    list_init(&task->timers);
+    list_init(&task->condw);
+    list_init(&task->vmas);
+    list_init(&task->runq);
+    rb_node_init(&task->fair);
+    cond_init(&task->chld_exit);
+}
+
+void task_cache_init(void)
+{
+    slab_cache_init(&task_cache, "task-cache", sizeof(struct task),
+            0, 0, task_ctor, NULL);
+    task_arch_cache_init();
+    vma_init();
+}
+
+int task_init(struct task *task, int flags)
 {
     static pid_t next_pid = 1;
     int i;
     struct task *sib;
 
+    /* memory */
+    if (flags & TASK_SPAWN) {
+        task->brk = 0;
+    } else {
+        if (vma_dup(&task->vmas, &current_task->vmas) < 0)
+            return -1;
+        task->brk = current_task->brk;
+    }
+    task->faults = 0;
+    task->vfork = (flags & TASK_VFORK) != 0;
+
     /* pids */
     task->pid = next_pid++;
     task->pgid = current_task->pgid;
@@ -56,19 +102,15 @@ int task_init(struct task *task)
         task->fd[i] = current_task->fd[i];
         task->fd[i].file->refs++;
     }
-    
-    /* memory */
-    task->brk = current_task->brk;
 
     /* sheduler */
-    task->state = TASK_RUNNING;
     task->counter = msecs_to_ticks(SCHED_TIMESLICE);
+    task->policy = current_task->policy;
+    task->prio = current_task->prio;
+    task->nice = current_task->nice;
+    task->vruntime = current_task->vruntime;
     task->exit_code = 0;
 
-    list_init(&task->tasks);
-    list_init(&task->children);
-    list_init(&task->sibling);
-
     /* Add to the global tasks list */
     list_insert_before(&current_task->tasks, &task->tasks);
     
@@ -78,36 +120,32 @@ int task_init(struct task *task)
     else
         list_insert_before(&sib->sibling, &task->sibling);
 
-    cond_init(&task->chld_exit);
-    
     /* signals */
     (void)sigemptyset(&task->sigpend);
     (void)sigemptyset(&task->sigmask);
     memcpy(task->signals, current_task->signals, sizeof(task->signals));
 
-    /* Timers events */
-    list_init(&task->timers);
-
-    /* Conditional wait link */
-    list_init(&task->condw);
+    /* Alarm event is initialized on first use */
+    task->alarm.func = NULL;
 
-    task_arch_init(&task->arch);
+    task_arch_init(&task->arch, flags);
 
+    wakeup(task);
     return 0;
 }
 
 void task_deinit(struct task *task)
 {
+    vma_clear(&task->vmas);
     task_arch_deinit(&task->arch);
 }
 
-struct task *task_create(void)
+struct task *task_create(int flags)
 {
-    struct task *task = kmalloc(sizeof(struct task), 0);
-    if (task)
-    {
-        memset(task, 0, sizeof(*task));
-        task_init(task);
+    struct task *task = slab_cache_alloc(&task_cache, 0);
+    if (task && task_init(task, flags) < 0) {
+        slab_cache_free(&task_cache, task);
+        task = NULL;
     }
     return task;
 }
@@ -115,7 +153,35 @@ struct task *task_create(void)
 void task_delete(struct task *task)
 {
     task_deinit(task);
-    kfree(task, sizeof(struct task));
+    slab_cache_free(&task_cache, task);
+}
+
+struct task *task_find(pid_t pid)
+{
+    struct task *t = current_task;
+
+    if (pid == 0)
+        return current_task;
+    do {
+        if (t->pid == pid)
+            return t;
+        t = list_container(t->tasks.next, struct task, tasks);
+    } while (t != current_task);
+    return NULL;
+}
+
+/*
+ * The parent sleeps on its children exit condition, also signaled when
+ * the child exits (see sys_exit).
+ */
+void task_vfork_release(struct task *task)
+{
+    struct task *parent = task->pptr;
+
+    spinlock_lock(&parent->chld_exit.lock);
+    task->vfork = 0;
+    cond_signal(&parent->chld_exit);
+    spinlock_unlock(&parent->chld_exit.lock);
 }
 
 void init_start(void)
@@ -123,7 +189,7 @@ void init_start(void)
     struct task *task;
     void init(void);
 
-    task = task_create();
+    task = task_create(0);
     if (task == NULL)
         panic("init_start");
 
@@ -24,6 +24,7 @@
 #include "fs/vfs.h"
 #include "sync/cond.h"
 #include "timer.h"
+#include "rbtree.h"
 #include <stdint.h>
 #include <limits.h>
 #include <sys/types.h>
@@ -37,6 +38,10 @@
 
 #define SIGNALS_NUM     (SIGUNUSED+1)
 
+/* Task creation flags (see task_create) */
+#define TASK_VFORK      1   /**< Borrow the parent memory until exec or exit */
+#define TASK_SPAWN      2   /**< Empty user memory, the program is loaded later */
+
 /** Process structure. */
 struct task
 {
@@ -55,11 +60,20 @@ struct task
     struct list_link    tasks;          /**< Tasks list link. */
     struct cond         chld_exit;      /**< Child exit condition */
     int                 counter;        /**< Remaining time slice for sched */
+    int                 policy;         /**< Scheduling policy */
+    int                 prio;           /**< Scheduling priority */
+    struct list_link    runq;           /**< Run queue link */
+    int                 nice;           /**< Fair class nice value */
+    unsigned long       vruntime;       /**< Fair class virtual runtime */
+    struct rb_node      fair;           /**< Fair class run queue node */
     int                 exit_code;      /**< Exit status */
     struct task         *pptr;          /**< Parent process */
     struct list_link    children;       /**< Children list (vertical) */
     struct list_link    sibling;        /**< Siblings list (horizontal) */
     uintptr_t           brk;            /**< Program break */
+    struct list_link    vmas;           /**< Virtual memory areas */
+    unsigned long       faults;         /**< Resolved user page faults */
+    int                 vfork;          /**< Parent suspended by vfork */
     sigset_t            sigpend;        /**< Pending signals */
     sigset_t            sigmask;        /**< Masked */
     struct sigaction    signals[SIGNALS_NUM];   /**< Signal handlers */
@@ -68,16 +82,58 @@ struct task
     struct list_link    condw;          /**< Conditional wait */
 };
 
-struct task *task_create(void);
+void task_cache_init(void);
+
+/**
+ * Create a copy of the current task.
+ *
+ * @param flags     Creation flags. By default the user memory is duplicated
+ *                  copy on write (fork). With TASK_VFORK the memory is
+ *                  shared until the child execs or exits (see
+ *                  task_vfork_release), with TASK_SPAWN the child starts
+ *                  with an empty user memory.
+ * @return          The new task, NULL on failure.
+ */
+struct task *task_create(int flags);
 void task_delete(struct task *task);
 
-int task_init(struct task *task);
+int task_init(struct task *task, int flags);
 void task_deinit(struct task *task);
 
+/**
+ * Find a task by process ID.
+ *
+ * @param pid       Process ID, zero for the current task.
+ * @return          Task with the given pid, NULL if not found.
+ */
+struct task *task_find(pid_t pid);
+
+/**
+ * Resume the parent suspended by vfork, the child no longer uses the
+ * parent memory.
+ *
+ * @param task      Task created with TASK_VFORK.
+ */
+void task_vfork_release(struct task *task);
+
+
+void task_arch_cache_init(void);
 
-int task_arch_init(struct task_arch *task);
+int task_arch_init(struct task_arch *task, int flags);
 void task_arch_deinit(struct task_arch *task);
 
+/**
+ * Start a new task in a kernel function. When the function returns the
+ * task goes to user space through the frame copied from the parent.
+ * The frame is reachable via the task 'ifr' while the function runs.
+ *
+ * @param task      Task architecture specific data.
+ * @param func      Entry function.
+ * @param arg       Entry function argument.
+ */
+void task_arch_entry(struct task_arch *task, void (*func)(void *),
+        void *arg);
+
 void task_arch_switch(struct task_arch *curr, struct task_arch *next);
 
 
@@ -0,0 +1,243 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "rbtree.h"
+
+static void rb_rotate_left(struct rb_tree *tree, struct rb_node *x)
+{
+    struct rb_node *y = x->right;
+
+    x->right = y->left;
+    if (y->left)
+        y->left->parent = x;
+    y->parent = x->parent;
+    if (!x->parent)
+        tree->root = y;
+    else if (x == x->parent->left)
+        x->parent->left = y;
+    else
+        x->parent->right = y;
+    y->left = x;
+    x->parent = y;
+}
+
+static void rb_rotate_right(struct rb_tree *tree, struct rb_node *x)
+{
+    struct rb_node *y = x->left;
+
+    x->left = y->right;
+    if (y->right)
+        y->right->parent = x;
+    y->parent = x->parent;
+    if (!x->parent)
+        tree->root = y;
+    else if (x == x->parent->right)
+        x->parent->right = y;
+    else
+        x->parent->left = y;
+    y->right = x;
+    x->parent = y;
+}
+
+void rb_insert(struct rb_tree *tree, struct rb_node *node, rb_less_t *less)
+{
+    struct rb_node **link = &tree->root, *parent = NULL, *gp, *uncle;
+    int leftmost = 1;
+
+    while (*link) {
+        parent = *link;
+        if (less(node, parent)) {
+            link = &parent->left;
+        } else {
+            link = &parent->right;
+            leftmost = 0;
+        }
+    }
+    node->parent = parent;
+    node->left = node->right = NULL;
+    node->red = 1;
+    *link = node;
+    if (leftmost)
+        tree->first = node;
+
+    /* Restore the red-black properties */
+    while ((parent = node->parent) && parent->red) {
+        gp = parent->parent;
+        if (parent == gp->left) {
+            uncle = gp->right;
+            if (uncle && uncle->red) {
+                parent->red = uncle->red = 0;
+                gp->red = 1;
+                node = gp;
+                continue;
+            }
+            if (node == parent->right) {
+                rb_rotate_left(tree, parent);
+                node = parent;
+                parent = node->parent;
+            }
+            parent->red = 0;
+            gp->red = 1;
+            rb_rotate_right(tree, gp);
+        } else {
+            uncle = gp->left;
+            if (uncle && uncle->red) {
+                parent->red = uncle->red = 0;
+                gp->red = 1;
+                node = gp;
+                continue;
+            }
+            if (node == parent->left) {
+                rb_rotate_right(tree, parent);
+                node = parent;
+                parent = node->parent;
+            }
+            parent->red = 0;
+            gp->red = 1;
+            rb_rotate_left(tree, gp);
+        }
+    }
+    tree->root->red = 0;
+}
+
+static struct rb_node *rb_next(struct rb_node *node)
+{
+    struct rb_node *parent;
+
+    if (node->right) {
+        node = node->right;
+        while (node->left)
+            node = node->left;
+        return node;
+    }
+    while ((parent = node->parent) && node == parent->right)
+        node = parent;
+    return parent;
+}
+
+/* Replace the subtree rooted at 'u' with the one rooted at 'v' */
+static void rb_transplant(struct rb_tree *tree, struct rb_node *u,
+        struct rb_node *v)
+{
+    if (!u->parent)
+        tree->root = v;
+    else if (u == u->parent->left)
+        u->parent->left = v;
+    else
+        u->parent->right = v;
+    if (v)
+        v->parent = u->parent;
+}
+
+void rb_erase(struct rb_tree *tree, struct rb_node *node)
+{
+    struct rb_node *child, *parent, *sibling, *y;
+    int red;
+
+    if (tree->first == node)
+        tree->first = rb_next(node);
+
+    /* Unlink the node, 'child' takes the place of the removed color */
+    if (!node->left || !node->right) {
+        child = node->left ? node->left : node->right;
+        parent = node->parent;
+        red = node->red;
+        rb_transplant(tree, node, child);
+    } else {
+        /* Replace the node with its successor */
+        y = node->right;
+        while (y->left)
+            y = y->left;
+        red = y->red;
+        child = y->right;
+        if (y->parent == node) {
+            parent = y;
+        } else {
+            parent = y->parent;
+            rb_transplant(tree, y, child);
+            y->right = node->right;
+            y->right->parent = y;
+        }
+        rb_transplant(tree, node, y);
+        y->left = node->left;
+        y->left->parent = y;
+        y->red = node->red;
+    }
+    rb_node_init(node);
+    if (red)
+        return;
+
+    /* A black node was removed, restore the black height */
+    while (child != tree->root && (!child || !child->red)) {
+        if (child == parent->left) {
+            sibling = parent->right;
+            if (sibling->red) {
+                sibling->red = 0;
+                parent->red = 1;
+                rb_rotate_left(tree, parent);
+                sibling = parent->right;
+            }
+            if ((!sibling->left || !sibling->left->red) &&
+                (!sibling->right || !sibling->right->red)) {
+                sibling->red = 1;
+                child = parent;
+                parent = child->parent;
+                continue;
+            }
+            if (!sibling->right || !sibling->right->red) {
+                sibling->left->red = 0;
+                sibling->red = 1;
+                rb_rotate_right(tree, sibling);
+                sibling = parent->right;
+            }
+            sibling->red = parent->red;
+            parent->red = 0;
+            sibling->right->red = 0;
+            rb_rotate_left(tree, parent);
+        } else {
+            sibling = parent->left;
+            if (sibling->red) {
+                sibling->red = 0;
+                parent->red = 1;
+                rb_rotate_right(tree, parent);
+                sibling = parent->left;
+            }
+            if ((!sibling->left || !sibling->left->red) &&
+                (!sibling->right || !sibling->right->red)) {
+                sibling->red = 1;
+                child = parent;
+                parent = child->parent;
+                continue;
+            }
+            if (!sibling->left || !sibling->left->red) {
+                sibling->right->red = 0;
+                sibling->red = 1;
+                rb_rotate_left(tree, sibling);
+                sibling = parent->left;
+            }
+            sibling->red = parent->red;
+            parent->red = 0;
+            sibling->left->red = 0;
+            rb_rotate_right(tree, parent);
+        }
+        child = tree->root;
+    }
+    if (child)
+        child->red = 0;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#ifndef _BEEOS_RBTREE_H_
+#define _BEEOS_RBTREE_H_
+
+#include <stddef.h>
+
+/** Red-black tree node, embedded in the ordered objects. */
+struct rb_node
+{
+    struct rb_node  *parent;    /**< Parent node, self if not linked. */
+    struct rb_node  *left;      /**< Left child. */
+    struct rb_node  *right;     /**< Right child. */
+    int             red;        /**< Node color. */
+};
+
+/** Red-black tree root, the leftmost (minimum) node is cached. */
+struct rb_tree
+{
+    struct rb_node  *root;      /**< Root node. */
+    struct rb_node  *first;     /**< Leftmost node. */
+};
+
+/**
+ * Nodes comparison function.
+ *
+ * @return  Non zero if the first node must be placed before the second.
+ */
+typedef int (rb_less_t)(const struct rb_node *a, const struct rb_node *b);
+
+/** Get the object containing a tree node. */
+#define rb_container(node, type, member) \
+    ((type *)((char *)(node) - offsetof(type, member)))
+
+static inline void rb_tree_init(struct rb_tree *tree)
+{
+    tree->root = NULL;
+    tree->first = NULL;
+}
+
+/** Mark a node as not linked in any tree. */
+static inline void rb_node_init(struct rb_node *node)
+{
+    node->parent = node;
+}
+
+/** Check if a node is linked in a tree. */
+static inline int rb_linked(const struct rb_node *node)
+{
+    return node->parent != node;
+}
+
+/** Leftmost node, NULL if the tree is empty. */
+static inline struct rb_node *rb_first(const struct rb_tree *tree)
+{
+    return tree->first;
+}
+
+/**
+ * Insert a node. Nodes comparing equal are placed after the existing ones.
+ *
+ * @param tree  Tree.
+ * @param node  Node to insert (not linked).
+ * @param less  Nodes comparison function.
+ */
+void rb_insert(struct rb_tree *tree, struct rb_node *node, rb_less_t *less);
+
+/**
+ * Remove a node. The node is marked as not linked.
+ *
+ * @param tree  Tree.
+ * @param node  Node to remove (linked in the tree).
+ */
+void rb_erase(struct rb_tree *tree, struct rb_node *node);
+
+#endif /* _BEEOS_RBTREE_H_ */
@@ -4,9 +4,11 @@ local_sources := kmain.c \
 				 panic.c \
 				 isr.c \
 				 elf.c \
-				 timer.c
+				 timer.c \
+				 rbtree.c \
+				 boot.c
 
-dirs := dev driver fs mm proc sync sys ipc
+dirs := dev driver fs mm proc sync sys ipc bench
 
 ifeq ($(ARCH),x86)
 dirs += arch/x86
@@ -31,7 +31,7 @@ void cond_init(struct cond *cond)
 void cond_wait(struct cond *cond)
 {
     list_insert_before(&cond->queue, &current_task->condw);
-    current_task->state = TASK_SLEEPING;
+    suspend(TASK_SLEEPING);
 
     spinlock_unlock(&cond->lock);
     scheduler();
@@ -46,7 +46,7 @@ void cond_signal(struct cond *cond)
         return;
     task = struct_ptr(cond->queue.next, struct task, condw);
     list_delete(&task->condw);
-    task->state = TASK_RUNNING;
+    wakeup(task);
 }
 
 void cond_broadcast(struct cond *cond)
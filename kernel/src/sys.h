@@ -24,10 +24,15 @@
 #include <sys/stat.h>
 #include <time.h>
 #include <signal.h>
+#include <spawn.h>
+#include <sched.h>
 
 
 void sys_exit(int status);
 pid_t sys_fork(void);
+pid_t sys_vfork(void);
+pid_t sys_spawn(const char *path, const char *argv[], const char *envp[],
+        const posix_spawnattr_t *attr);
 
 ssize_t sys_read(int fd, void *buf, size_t count);
 ssize_t sys_write(int fd, const void *buf, size_t count);
@@ -62,12 +67,21 @@ int sys_execve(const char *path, const char *argv[], const char *envp[]);
 
 void *sys_sbrk(intptr_t incr);
 
+void *sys_mmap(void *addr, size_t length, int prot, int flags, int fd,
+        off_t offset);
+
+int sys_munmap(void *addr, size_t length);
+
+int sys_mprotect(void *addr, size_t length, int prot);
+
 int sys_nanosleep(const struct timespec *req, struct timespec *rem);
 
 int sys_fstat(int fd, struct stat *buf);
 
 int sys_info(int type);
 
+int sys_kmemstat(int what, void *buf, size_t size);
+
 int sys_sigaction(int sig, const struct sigaction *act,
         struct sigaction *oact);
 
@@ -85,6 +99,17 @@ int sys_chdir(const char *path);
 
 unsigned int sys_alarm(unsigned int seconds);
 
+int sys_getpriority(int which, id_t who);
+
+int sys_setpriority(int which, id_t who, int prio);
+
+int sys_sched_setscheduler(pid_t pid, int policy,
+        const struct sched_param *param);
+
+int sys_sched_getscheduler(pid_t pid);
+
+int sys_sched_getparam(pid_t pid, struct sched_param *param);
+
 void syscall_init(void);
 
 
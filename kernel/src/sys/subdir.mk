@@ -2,6 +2,8 @@ local_sources := syscall.c \
 				 sys_execve.c \
 				 sys_exit.c \
 				 sys_fork.c \
+				 sys_vfork.c \
+				 sys_spawn.c \
 				 sys_fstat.c \
 				 sys_getpid.c \
 				 sys_getppid.c \
@@ -13,6 +15,7 @@ local_sources := syscall.c \
 				 sys_tcsetpgrp.c \
 				 sys_getcwd.c \
 				 sys_info.c \
+				 sys_kmemstat.c \
 				 sys_nanosleep.c \
 				 sys_mknod.c \
 				 sys_open.c \
@@ -22,6 +25,9 @@ local_sources := syscall.c \
 				 sys_dup2.c \
 				 sys_read.c \
 				 sys_sbrk.c \
+				 sys_mmap.c \
+				 sys_munmap.c \
+				 sys_mprotect.c \
 				 sys_setgid.c \
 				 sys_setuid.c \
 				 sys_waitpid.c \
@@ -33,4 +39,9 @@ local_sources := syscall.c \
 				 sys_sigprocmask.c \
 				 sys_pipe.c \
 				 sys_chdir.c \
-				 sys_alarm.c
+				 sys_alarm.c \
+				 sys_getpriority.c \
+				 sys_setpriority.c \
+				 sys_sched_setscheduler.c \
+				 sys_sched_getscheduler.c \
+				 sys_sched_getparam.c
@@ -28,6 +28,7 @@ void fs_file_free(struct file *file);
 int sys_close(int fdn)
 {
     struct file *file;
+    struct inode *inode;
 
     /* Validate file descriptor */
     if (fdn < 0 || OPEN_MAX <= fdn || !current_task->fd[fdn].file)
@@ -41,12 +42,15 @@ int sys_close(int fdn)
     file->refs--;
     if (file->refs == 0)
     {
-        iput(file->inode);  /* Before the NULL write!!! */
-        if (S_ISFIFO(file->inode->mode))
+        inode = file->inode;
+        if (S_ISFIFO(inode->mode) && inode->ref > 1)
+        {
+            iput(inode);  /* Before the NULL write!!! */
             /* Wake up the other end, to allow EOF recv in user space */
-            fs_write(file->inode, NULL, 0, 0);
-
-        /* TODO VFS op required. iput of pipe_inode is different */
+            fs_write(inode, NULL, 0, 0);
+        }
+        else
+            iput(inode);  /* Last reference, the inode is released */
         fs_file_free(file);
     }
 
@@ -21,6 +21,7 @@
 #include "elf.h"
 #include "kmalloc.h"
 #include "proc.h"
+#include "mm/vma.h"
 #include "arch/x86/paging.h"
 
 #include <sys/types.h>
@@ -71,55 +72,73 @@ static void stack_init(uintptr_t *base, const char *argv[], const char *envp[])
 }
 
 
-int sys_execve(const char *path, const char *argv[], const char *envp[])
+int exec_prepare(struct exec_image *img, const char *path,
+        const char *argv[], const char *envp[])
 {
-    int ret = 0;
-    struct elf_hdr eh;
-    struct elf_prog_hdr ph;
-    struct inode *inode;
-    unsigned int i, off;
-    uint32_t pgdir, vaddr;
-    void *ustack;
-
-    if (current_task->arch.ifr == NULL || argv == NULL)
+    if (argv == NULL)
         return -EINVAL;
-    
-    inode = fs_namei(path);
-    if (!inode)
+
+    img->inode = fs_namei(path);
+    if (!img->inode)
         return -ENOENT;
 
-    if (fs_read(inode, &eh, sizeof(eh), 0) != sizeof(eh)
-        || eh.magic != ELF_MAGIC)
+    if (fs_read(img->inode, &img->eh, sizeof(img->eh), 0) != sizeof(img->eh)
+        || img->eh.magic != ELF_MAGIC) {
+        iput(img->inode);
         return -ENOEXEC;
+    }
 
     /* Immediatelly copy argv and envp arrays in a temporary user stack
      * allocated via kmalloc (shared betweek virtual spaces). */
-    ustack = kmalloc(ARG_MAX, 0);
-    if (!ustack)
+    img->ustack = kmalloc(ARG_MAX, 0);
+    if (!img->ustack) {
+        iput(img->inode);
         return -ENOMEM;
-    stack_init(ustack, argv, envp);
+    }
+    stack_init(img->ustack, argv, envp);
+    return 0;
+}
+
+void exec_release(struct exec_image *img)
+{
+    kfree(img->ustack, ARG_MAX);
+    iput(img->inode);
+}
 
+int exec_load(struct exec_image *img)
+{
+    int ret = 0;
+    struct elf_hdr *eh = &img->eh;
+    struct elf_prog_hdr ph;
+    struct inode *inode = img->inode;
+    unsigned int i, off, npages;
+    uint32_t pgdir, vaddr, brk = 0, end = 0;
+    struct list_link vmas;
+    struct vma *vma;
+    int flags;
+
+    list_init(&vmas);
     pgdir = page_dir_dup(0);
     page_dir_switch(pgdir);
 
     /* The function has been called via a syscall */
     /* TODO: Create user stack only if we where in user space
      * Otherwise esp is not in the frame */
-    /* Minimal user stack */
-    if ((ret = (int)page_map((char *)KVBASE-PAGE_SIZE, -1)) < 0) {
-        kfree(ustack, ARG_MAX);
+    /* Minimal user stack, grows on demand */
+    if (!vma_create(&vmas, KVBASE-PAGE_SIZE, KVBASE,
+                    VMA_READ | VMA_WRITE | VMA_STACK)) {
+        ret = -ENOMEM;
         goto bad;
     }
-    memcpy((char *)KVBASE-ARG_MAX, ustack, ARG_MAX);
+    if ((ret = (int)page_map((char *)KVBASE-PAGE_SIZE, -1)) < 0)
+        goto bad;
+    memcpy((char *)KVBASE-ARG_MAX, img->ustack, ARG_MAX);
     
     /* Release user stack copy */
-    kfree(ustack, ARG_MAX);
+    kfree(img->ustack, ARG_MAX);
+    img->ustack = NULL;
 
-    /* Start with an unknown program break */
-    current_task->brk = 0;
-
-    for (i = 0, off = eh.phoff; i < eh.phnum; i++, off += sizeof(ph)) {
-        
+    for (i = 0, off = eh->phoff; i < eh->phnum; i++, off += sizeof(ph)) {
         if (fs_read(inode, &ph, sizeof(ph), off) != sizeof(ph)) {
             ret = -ENOEXEC;
             goto bad;
@@ -129,7 +148,8 @@ int sys_execve(const char *path, const char *argv[], const char *envp[])
             continue;
         
         if (ph.memsz < ph.filesz ||
-            KVBASE <= ph.vaddr + ph.memsz) {
+            KVBASE <= ph.vaddr + ph.memsz ||
+            ph.offset < ph.vaddr - ALIGN_DOWN(ph.vaddr, PAGE_SIZE)) {
             ret = -ENOEXEC;
             goto bad;
         }
@@ -137,26 +157,46 @@ int sys_execve(const char *path, const char *argv[], const char *envp[])
         /* Look for program brk (temporary... not very elegant) */
         if ((ph.flags & ELF_PROG_FLAG_READ) &&
             (ph.flags & ELF_PROG_FLAG_WRITE) &&
-            current_task->brk < ph.vaddr+ph.memsz) {
-            current_task->brk = ph.vaddr+ph.memsz;
+            brk < ph.vaddr+ph.memsz) {
+            brk = ph.vaddr+ph.memsz;
         }
-
-        for (vaddr = ALIGN_DOWN(ph.vaddr, PAGE_SIZE);
-             vaddr < ph.vaddr + ph.memsz;
-             vaddr += PAGE_SIZE) {
-            if ((ret = (int)page_map((char *)vaddr, -1)) < 0)
-                goto bad;
+        if (end < ph.vaddr+ph.memsz)
+            end = ph.vaddr+ph.memsz;
+
+        vaddr = ALIGN_DOWN(ph.vaddr, PAGE_SIZE);
+        npages = (ALIGN_UP(ph.vaddr + ph.memsz, PAGE_SIZE) - vaddr) / PAGE_SIZE;
+        flags = 0;
+        if (ph.flags & ELF_PROG_FLAG_READ)
+            flags |= VMA_READ;
+        if (ph.flags & ELF_PROG_FLAG_WRITE)
+            flags |= VMA_WRITE;
+        if (ph.flags & ELF_PROG_FLAG_EXEC)
+            flags |= VMA_EXEC;
+        vma = vma_create(&vmas, vaddr, vaddr + npages * PAGE_SIZE, flags);
+        if (!vma) {
+            ret = -ENOEXEC;
+            goto bad;
         }
+        /* Pages are loaded from the file on first access */
+        vma_set_file(vma, inode, ph.offset - (ph.vaddr - vaddr),
+                     ph.vaddr + ph.filesz);
+    }
 
-        if (ph.filesz != 0) {
-            if ((ret = fs_read(inode, (void *)ph.vaddr, ph.filesz, ph.offset)) 
-                    != ph.filesz)
-                goto bad;
-        }
-        if (ph.memsz - ph.filesz > 0)
-            memset((void *)(ph.vaddr + ph.filesz), 0, ph.memsz - ph.filesz);
+    /* Empty heap area, after the data (or whatever is the last segment) */
+    if (brk == 0)
+        brk = end;
+    if (!vma_create(&vmas, ALIGN_UP(brk, PAGE_SIZE), ALIGN_UP(brk, PAGE_SIZE),
+                    VMA_READ | VMA_WRITE | VMA_HEAP)) {
+        ret = -ENOEXEC;
+        goto bad;
     }
 
+    /* Replace the process memory areas */
+    current_task->brk = brk;
+    vma_clear(&current_task->vmas);
+    list_merge(&current_task->vmas, &vmas);
+    list_delete(&vmas);
+
     /*** FIXME ARCH specific code ***/
 
     /* Release the old dir just before jump */
@@ -165,7 +205,7 @@ int sys_execve(const char *path, const char *argv[], const char *envp[])
 
     /* We assume that ARG_MAX is lass than PAGE_SIZE */
     current_task->arch.ifr->usr_esp = KVBASE-ARG_MAX;
-    current_task->arch.ifr->eip = eh.entry;
+    current_task->arch.ifr->eip = eh->entry;
 
     /*
      * POSIX1. All signals are set to their default action unless the process
@@ -180,12 +220,34 @@ int sys_execve(const char *path, const char *argv[], const char *envp[])
         }
     }
 
+    /* The parent memory is no longer used */
+    if (current_task->vfork)
+        task_vfork_release(current_task);
+
+    /* The memory areas hold their own references */
+    iput(inode);
     return ret;
 
 bad:
+    vma_clear(&vmas);
     /* Switch back to the old dir */
     page_dir_switch(current_task->arch.pgdir);
     /* Release the new dir, this also release all the mapped pages. */
     page_dir_del(pgdir);
+    if (img->ustack)
+        kfree(img->ustack, ARG_MAX);
+    iput(inode);
     return ret;
 }
+
+int sys_execve(const char *path, const char *argv[], const char *envp[])
+{
+    struct exec_image img;
+    int ret;
+
+    if (current_task->arch.ifr == NULL)
+        return -EINVAL;
+    if ((ret = exec_prepare(&img, path, argv, envp)) < 0)
+        return ret;
+    return exec_load(&img);
+}
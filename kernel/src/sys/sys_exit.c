@@ -139,8 +139,9 @@ void sys_exit(int status)
 
     /* Acquire the father conditional variable to prevent lost signals */
     spinlock_lock(&current_task->pptr->chld_exit.lock);
-    current_task->state = TASK_ZOMBIE;
+    suspend(TASK_ZOMBIE);
     current_task->exit_code = status;
+    current_task->vfork = 0;    /* Eventually resume the vfork parent */
     cond_signal(&current_task->pptr->chld_exit);
     spinlock_unlock(&current_task->pptr->chld_exit.lock);
 
@@ -24,7 +24,7 @@ pid_t sys_fork(void)
 {
     struct task *child;
     
-    child = task_create();
+    child = task_create(0);
     if (child == NULL)
         return -1;
     return child->pid;
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "sys.h"
+#include "proc.h"
+#include <sys/resource.h>
+#include <errno.h>
+
+/*
+ * Returns the highest priority (lowest nice value) of the selected
+ * processes. As in Linux, the value is returned biased as 20 - nice to
+ * keep it positive, the library reverts the conversion.
+ */
+
+int sys_getpriority(int which, id_t who)
+{
+    struct task *t = current_task;
+    int nice = NICE_MAX + 1;
+
+    if (which != PRIO_PROCESS && which != PRIO_PGRP && which != PRIO_USER)
+        return -EINVAL;
+    if (who == 0) {
+        if (which == PRIO_PROCESS)
+            who = current_task->pid;
+        else if (which == PRIO_PGRP)
+            who = current_task->pgid;
+        else
+            who = current_task->uid;
+    }
+    do {
+        if (t->pid != 0 &&  /* Not the idle task */
+            ((which == PRIO_PROCESS && t->pid == who) ||
+             (which == PRIO_PGRP && t->pgid == who) ||
+             (which == PRIO_USER && t->uid == who)) && t->nice < nice)
+            nice = t->nice;
+        t = struct_ptr(t->tasks.next, struct task, tasks);
+    } while (t != current_task);
+
+    return (nice <= NICE_MAX) ? 20 - nice : -ESRCH;
+}
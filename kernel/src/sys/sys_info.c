@@ -22,10 +22,14 @@
 
 void frame_dump();
 void proc_dump();
+void kmalloc_dump();
+void timer_dump();
 
 int sys_info(int type)
 {
     frame_dump();
+    kmalloc_dump();
     proc_dump();
+    timer_dump();
     return 0;
 }
@@ -59,7 +59,7 @@ int sys_kill(pid_t pid, int sig)
                     {
                         if (!list_empty(&t->condw))
                             list_delete(&t->condw);
-                        t->state = TASK_RUNNING;
+                        wakeup(t);
                     }
                 }
             }
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+#include "sys.h"
+#include "mm/frame.h"
+#include "mm/slab.h"
+#include <sys/kmem.h>
+#include <errno.h>
+
+int sys_kmemstat(int what, void *buf, size_t size)
+{
+    int ret;
+
+    switch (what)
+    {
+    case KMEM_CACHES:
+        ret = slab_stat(buf, size / sizeof(struct kmem_cache_stat));
+        break;
+    case KMEM_ZONES:
+        ret = frame_stat(buf, size / sizeof(struct kmem_zone_stat));
+        break;
+    default:
+        ret = -EINVAL;
+        break;
+    }
+    return ret;
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "sys.h"
+#include "proc.h"
+#include "fs/vfs.h"
+#include "mm/vma.h"
+#include "util.h"
+#include <sys/mman.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include "arch/x86/paging.h"
+
+/*
+ * Anonymous mappings are zero filled on demand. With MAP_LARGE they are
+ * aligned to the large page size and backed by large pages if possible.
+ * File mappings are populated on demand with the file content, read only
+ * mappings share the frames of the page cache (see mm/pcache.h). Changes
+ * are never written back to the file, thus writeable shared file mappings
+ * are refused. Shared anonymous mappings are not supported.
+ */
+void *sys_mmap(void *addr, size_t length, int prot, int flags, int fd,
+        off_t offset)
+{
+    uintptr_t start, end, fend;
+    size_t size, align = PAGE_SIZE;
+    struct inode *inode = NULL;
+    struct file *file;
+    struct vma *vma;
+    int ret;
+
+    if (flags & MAP_LARGE) {
+        if ((flags & (MAP_ANONYMOUS | MAP_PRIVATE)) !=
+            (MAP_ANONYMOUS | MAP_PRIVATE))
+            return (void *)-EINVAL;
+        align = LARGE_PAGE_SIZE;
+    }
+    size = ALIGN_UP(length, align);
+    if (length == 0 || size < length || offset < 0 ||
+        (offset & (PAGE_SIZE - 1)) ||
+        (prot & ~(PROT_READ | PROT_WRITE | PROT_EXEC)))
+        return (void *)-EINVAL;
+    /* Exactly one of MAP_SHARED and MAP_PRIVATE */
+    if (!(flags & MAP_SHARED) == !(flags & MAP_PRIVATE))
+        return (void *)-EINVAL;
+    if ((flags & MAP_SHARED) && (flags & MAP_ANONYMOUS))
+        return (void *)-EINVAL;
+
+    if (!(flags & MAP_ANONYMOUS)) {
+        if (fd < 0 || OPEN_MAX <= fd || !current_task->fd[fd].file)
+            return (void *)-EBADF;
+        file = current_task->fd[fd].file;
+        inode = file->inode;
+        if (!inode || !S_ISREG(inode->mode))
+            return (void *)-ENODEV;
+        if ((file->flags & O_ACCMODE) == O_WRONLY)
+            return (void *)-EACCES;
+        if ((flags & MAP_SHARED) && (prot & PROT_WRITE))
+            return (void *)-EINVAL;
+    }
+
+    if (flags & MAP_FIXED) {
+        start = (uintptr_t)addr;
+        end = start + size;
+        if ((start & (align - 1)) || start == 0 || end <= start ||
+            end > VMA_MMAP_TOP)
+            return (void *)-EINVAL;
+        /* Replace the current mappings */
+        if ((ret = sys_munmap(addr, size)) < 0)
+            return (void *)ret;
+    } else {
+        start = vma_find_free(&current_task->vmas, size, align,
+                VMA_MMAP_TOP);
+        if (start == 0)
+            return (void *)-ENOMEM;
+        end = start + size;
+    }
+
+    /* Protection bits have the same values of the area access flags */
+    vma = vma_create(&current_task->vmas, start, end,
+            prot | ((flags & MAP_LARGE) ? VMA_LARGE : 0) |
+            ((flags & MAP_SHARED) ? VMA_SHARED : 0));
+    if (!vma)
+        return (void *)-ENOMEM;
+    if (inode) {
+        fend = start;
+        if (offset < inode->size)
+            fend += MIN(inode->size - offset, size);
+        vma_set_file(vma, inode, offset, fend);
+    }
+    return (void *)start;
+}
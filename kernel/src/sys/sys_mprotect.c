@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "sys.h"
+#include "proc.h"
+#include "mm/vma.h"
+#include "util.h"
+#include <sys/mman.h>
+#include <errno.h>
+#include "arch/x86/paging.h"
+
+/* Protection bits have the same values of the area access flags */
+#define VMA_ACCESS  (VMA_READ | VMA_WRITE | VMA_EXEC)
+
+int sys_mprotect(void *addr, size_t length, int prot)
+{
+    uintptr_t start = (uintptr_t)addr, end, next;
+    struct list_link *l;
+    struct vma *vma;
+    int ret;
+
+    end = ALIGN_UP(start + length, PAGE_SIZE);
+    if ((start & (PAGE_SIZE - 1)) || end < start || end > KVBASE ||
+        (prot & ~(PROT_READ | PROT_WRITE | PROT_EXEC)))
+        return -EINVAL;
+
+    /*
+     * The whole range shall be mapped. Shared file areas can't be made
+     * writeable, the changes would land on private copies.
+     */
+    for (next = start; next < end; next = vma->end) {
+        vma = vma_find(&current_task->vmas, next);
+        if (!vma)
+            return -ENOMEM;
+        if ((vma->flags & VMA_SHARED) && (prot & PROT_WRITE))
+            return -EACCES;
+    }
+    if ((ret = vma_isolate(&current_task->vmas, start, end,
+                           LARGE_PAGE_SIZE)) < 0)
+        return ret;
+
+    for (l = current_task->vmas.next; l != &current_task->vmas; l = l->next) {
+        vma = list_container(l, struct vma, link);
+        if (vma->end <= start)
+            continue;
+        if (vma->start >= end)
+            break;
+        vma->flags = (vma->flags & ~VMA_ACCESS) | (prot & VMA_ACCESS);
+        page_protect(vma->start, vma->end, vma->flags);
+    }
+    return 0;
+}
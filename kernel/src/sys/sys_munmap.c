@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "sys.h"
+#include "proc.h"
+#include "mm/vma.h"
+#include "util.h"
+#include <errno.h>
+#include "arch/x86/paging.h"
+
+int sys_munmap(void *addr, size_t length)
+{
+    uintptr_t start = (uintptr_t)addr, end;
+    struct list_link *l, *next;
+    struct vma *vma;
+    struct page_batch batch;
+    int ret;
+
+    end = ALIGN_UP(start + length, PAGE_SIZE);
+    if ((start & (PAGE_SIZE - 1)) || length == 0 || end <= start ||
+        end > KVBASE)
+        return -EINVAL;
+    if ((ret = vma_isolate(&current_task->vmas, start, end,
+                           LARGE_PAGE_SIZE)) < 0)
+        return ret;
+
+    page_batch_init(&batch);
+    for (l = current_task->vmas.next; l != &current_task->vmas; l = next) {
+        next = l->next;
+        vma = list_container(l, struct vma, link);
+        if (vma->end <= start)
+            continue;
+        if (vma->start >= end)
+            break;
+        page_unmap_range(&batch, vma->start, vma->end);
+        vma_delete(vma);
+    }
+    page_batch_flush(&batch);
+    return 0;
+}
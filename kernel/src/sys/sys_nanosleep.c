@@ -28,8 +28,7 @@ extern unsigned long timer_ticks;
 
 static void sleep_timer_handler(void *data)
 {
-    struct task *task = (struct task *)data;
-    task->state = TASK_RUNNING;
+    wakeup((struct task *)data);
 }
 
 int sys_nanosleep(const struct timespec *req, struct timespec *rem)
@@ -42,7 +41,7 @@ int sys_nanosleep(const struct timespec *req, struct timespec *rem)
     if (req->tv_sec < 0 || req->tv_nsec < 0 || req->tv_nsec > 999999999)
         return -EINVAL;
 
-    current_task->state = TASK_SLEEPING;
+    suspend(TASK_SLEEPING);
     
     ms = req->tv_sec * 1000 + req->tv_nsec / 1000000;
     when = timer_ticks + msecs_to_ticks(ms);
@@ -55,7 +54,7 @@ int sys_nanosleep(const struct timespec *req, struct timespec *rem)
 
     scheduler();
 
-    list_delete(&tm.link); /* in case of an early wakeup we are still linked */
+    timer_event_del(&tm); /* in case of an early wakeup we are still linked */
     list_delete(&tm.plink);
 
     now = timer_ticks;
@@ -20,7 +20,6 @@
 #include "fs/vfs.h"
 #include "proc.h"
 #include "dev.h"
-#include "kmalloc.h"
 #include "driver/tty.h"
 #include <unistd.h>
 #include <errno.h>
@@ -48,7 +47,9 @@ int sys_open(const char *pathname, int flags, mode_t mode)
     // TODO : temporary just to allow to proceed
     if (strcmp(pathname, "console") == 0)
     {
-        inode = kmalloc(sizeof(struct inode), 0);
+        inode = fs_inode_alloc();
+        if (inode == NULL)
+            return -ENOMEM;
         memset(inode, 0, sizeof(*inode));
         inode->mode = S_IFCHR;
         inode->dev = tty_get();
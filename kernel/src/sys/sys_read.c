@@ -21,6 +21,7 @@
 #include "dev.h"
 #include "fs/vfs.h"
 #include "proc.h"
+#include "mm/vma.h"
 #include <stddef.h>
 #include <errno.h>
 #include <limits.h>
@@ -29,6 +30,7 @@
 ssize_t sys_read(int fdn, void *buf, size_t count)
 {
     ssize_t n;
+    size_t size;
     struct file *file;
     
     if (OPEN_MAX <= fdn || !current_task->fd[fdn].file)
@@ -40,6 +42,11 @@ ssize_t sys_read(int fdn, void *buf, size_t count)
     if (!file->inode)
         return -1;
 
+    /* A directory read returns a single entry */
+    size = S_ISDIR(file->inode->mode) ? sizeof(struct dirent) : count;
+    if (vma_access(&current_task->vmas, (uintptr_t)buf, size, 1) < 0)
+        return -EFAULT;
+
     switch (file->inode->mode & S_IFMT) {
         case S_IFBLK:
         case S_IFCHR:
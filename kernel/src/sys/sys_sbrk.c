@@ -18,6 +18,8 @@
  */
 
 #include "proc.h"
+#include "mm/vma.h"
+#include "util.h"
 #include <unistd.h>
 #include <errno.h>
 #include "arch/x86/paging.h"
@@ -25,8 +27,25 @@
 
 void *sys_sbrk(intptr_t incr)
 {
-    uintptr_t addr;
+    uintptr_t addr, end, old_end;
+    struct vma *heap;
+    struct page_batch batch;
+
     addr = current_task->brk;
+    heap = vma_find_flags(&current_task->vmas, VMA_HEAP);
+    if (heap != NULL) {
+        /* Heap pages are mapped on demand within the area */
+        end = ALIGN_UP(addr + incr, PAGE_SIZE);
+        if (end < heap->start)
+            return (void *)-EINVAL;
+        old_end = heap->end;
+        if (vma_resize(&current_task->vmas, heap, heap->start, end) < 0)
+            return (void *)-ENOMEM;
+        page_batch_init(&batch);
+        if (end < old_end)
+            page_unmap_range(&batch, end, old_end);
+        page_batch_flush(&batch);
+    }
     current_task->brk += incr;
     return (void *)addr;
 }
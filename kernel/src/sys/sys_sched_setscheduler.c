@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "sys.h"
+#include "proc.h"
+#include <errno.h>
+
+/*
+ * Real-time policies and the change of the policy of a process owned by
+ * another user require superuser privileges.
+ */
+
+int sys_sched_setscheduler(pid_t pid, int policy,
+        const struct sched_param *param)
+{
+    struct task *t;
+    int rtprio;
+
+    if (pid < 0 || param == NULL)
+        return -EINVAL;
+    rtprio = param->sched_priority;
+    if (policy == SCHED_FIFO || policy == SCHED_RR) {
+        if (rtprio < SCHED_RT_PRIO_MIN || rtprio > SCHED_RT_PRIO_MAX)
+            return -EINVAL;
+    } else if (policy != SCHED_OTHER || rtprio != 0) {
+        return -EINVAL;
+    }
+
+    t = task_find(pid);
+    if (t == NULL)
+        return -ESRCH;
+    if (current_task->euid != 0 &&
+        (policy != SCHED_OTHER || t->euid != current_task->euid))
+        return -EPERM;
+
+    sched_setpolicy(t, policy, rtprio);
+    return 0;
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "sys.h"
+#include "proc.h"
+#include <sys/resource.h>
+#include <errno.h>
+
+/*
+ * Sets the nice value of the selected processes. The value is clamped
+ * to the valid range. Only the superuser can lower it or change the
+ * processes of other users.
+ * The new weight is used starting from the next scheduler tick.
+ */
+
+int sys_setpriority(int which, id_t who, int prio)
+{
+    struct task *t = current_task;
+    int found = 0, res = 0;
+
+    if (which != PRIO_PROCESS && which != PRIO_PGRP && which != PRIO_USER)
+        return -EINVAL;
+    if (prio < NICE_MIN)
+        prio = NICE_MIN;
+    else if (prio > NICE_MAX)
+        prio = NICE_MAX;
+
+    if (who == 0) {
+        if (which == PRIO_PROCESS)
+            who = current_task->pid;
+        else if (which == PRIO_PGRP)
+            who = current_task->pgid;
+        else
+            who = current_task->uid;
+    }
+    do {
+        if (t->pid != 0 &&  /* Not the idle task */
+            ((which == PRIO_PROCESS && t->pid == who) ||
+             (which == PRIO_PGRP && t->pgid == who) ||
+             (which == PRIO_USER && t->uid == who))) {
+            found = 1;
+            if (current_task->euid != 0 &&
+                t->uid != current_task->euid &&
+                t->euid != current_task->euid)
+                res = -EPERM;
+            else if (prio < t->nice && current_task->euid != 0)
+                res = -EACCES;
+            else
+                t->nice = prio;
+        }
+        t = struct_ptr(t->tasks.next, struct task, tasks);
+    } while (t != current_task);
+
+    return found ? res : -ESRCH;
+}
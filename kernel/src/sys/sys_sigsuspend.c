@@ -35,7 +35,7 @@ int sys_sigsuspend(const sigset_t *mask)
      * pending signals using the current mask */
     while (do_signal() < 0)
     {
-        current_task->state = TASK_SLEEPING;
+        suspend(TASK_SLEEPING);
         scheduler(); /* Release the CPU */
     }
     sys_sigprocmask(SIG_SETMASK, &omask, NULL);
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "sys.h"
+#include "proc.h"
+#include "kmalloc.h"
+#include <spawn.h>
+#include <errno.h>
+#include <string.h>
+
+/*
+ * Entry of the spawned process, the program is loaded in the child
+ * address space before returning to user mode.
+ */
+static void spawn_start(void *arg)
+{
+    struct exec_image *img = arg;
+    int ret;
+
+    ret = exec_load(img);
+    kfree(img, sizeof(*img));
+    if (ret < 0)
+        sys_exit(127);
+    current_task->arch.ifr = NULL;
+}
+
+static void spawn_attr(struct task *task, const posix_spawnattr_t *attr)
+{
+    int sig;
+
+    if (attr->flags & POSIX_SPAWN_SETPGROUP)
+        task->pgid = (attr->pgroup != 0) ? attr->pgroup : task->pid;
+    if (attr->flags & POSIX_SPAWN_SETSIGMASK)
+        task->sigmask = attr->sigmask;
+    if (attr->flags & POSIX_SPAWN_SETSIGDEF) {
+        for (sig = 1; sig < SIGNALS_NUM; sig++) {
+            if (sigismember(&attr->sigdefault, sig) <= 0)
+                continue;
+            memset(&task->signals[sig-1], 0, sizeof(struct sigaction));
+            task->signals[sig-1].sa_handler = SIG_DFL;
+        }
+    }
+}
+
+/*
+ * The arguments are copied in the parent, then the child starts with an
+ * empty user memory and loads the program (the parent memory is never
+ * duplicated). Failures after the child creation are reported via the
+ * child exit status (127).
+ */
+pid_t sys_spawn(const char *path, const char *argv[], const char *envp[],
+        const posix_spawnattr_t *attr)
+{
+    struct exec_image *img;
+    struct task *child;
+    int ret;
+
+    if (current_task->arch.ifr == NULL)
+        return -EINVAL;
+    img = kmalloc(sizeof(*img), 0);
+    if (img == NULL)
+        return -ENOMEM;
+    if ((ret = exec_prepare(img, path, argv, envp)) < 0) {
+        kfree(img, sizeof(*img));
+        return ret;
+    }
+
+    child = task_create(TASK_SPAWN);
+    if (child == NULL) {
+        exec_release(img);
+        kfree(img, sizeof(*img));
+        return -ENOMEM;
+    }
+    if (attr != NULL)
+        spawn_attr(child, attr);
+    task_arch_entry(&child->arch, spawn_start, img);
+    return child->pid;
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "proc.h"
+#include "proc/task.h"
+
+/*
+ * The child runs in the parent memory, the parent sleeps until the child
+ * execs or exits (see task_vfork_release).
+ */
+pid_t sys_vfork(void)
+{
+    struct task *child;
+    pid_t pid;
+
+    child = task_create(TASK_VFORK);
+    if (child == NULL)
+        return -1;
+    pid = child->pid;
+
+    spinlock_lock(&current_task->chld_exit.lock);
+    while (child->vfork)
+        cond_wait(&current_task->chld_exit);
+    spinlock_unlock(&current_task->chld_exit.lock);
+    return pid;
+}
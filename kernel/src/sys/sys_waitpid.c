@@ -19,8 +19,10 @@
 
 #include <unistd.h>
 #include <sys/wait.h>
+#include <errno.h>
 #include "proc.h"
 #include "util.h"
+#include "mm/vma.h"
 #include "kprintf.h"    // TODO : remove
 #include "kmalloc.h"
 
@@ -33,6 +35,11 @@ pid_t sys_waitpid(pid_t pid, int *wstatus, int options)
     struct task *t;
     int havekids;
 
+    /* The status is stored with the exit lock held */
+    if (wstatus && vma_access(&current_task->vmas, (uintptr_t)wstatus,
+                sizeof(*wstatus), 1) < 0)
+        return -EFAULT;
+
     spinlock_lock(&current_task->chld_exit.lock);
 
     while (1)
@@ -20,6 +20,8 @@
 #include "sys.h"
 #include "dev.h"
 #include "fs/vfs.h"
+#include "mm/pcache.h"
+#include "mm/vma.h"
 #include "proc.h"
 #include <stddef.h>
 #include <errno.h>
@@ -40,6 +42,9 @@ ssize_t sys_write(int fdn, const void *buf, size_t count)
     if (!file->inode)
         return -1;
 
+    if (vma_access(&current_task->vmas, (uintptr_t)buf, count, 0) < 0)
+        return -EFAULT;
+
     switch (file->inode->mode & S_IFMT) {
         case S_IFBLK:
         case S_IFCHR:
@@ -50,6 +55,15 @@ ssize_t sys_write(int fdn, const void *buf, size_t count)
             n = -EBADF;
             break;
         case S_IFREG:
+            /* The mapped pages would never see the new content */
+            if (file->inode->mapped != 0) {
+                n = -ETXTBSY;
+                break;
+            }
+            /* Drop the pages cached for the past mappings */
+            if (file->inode->pages != NULL)
+                pcache_release(file->inode);
+            /* fall through */
         case S_IFIFO:
         case S_IFSOCK:
             n = fs_write(file->inode, buf, count, file->offset);
@@ -28,6 +28,8 @@ static void *syscalls[] =
 {
     [__NR_exit]         = sys_exit,
     [__NR_fork]         = sys_fork,
+    [__NR_vfork]        = sys_vfork,
+    [__NR_spawn]        = sys_spawn,
     [__NR_read]         = sys_read,
     [__NR_write]        = sys_write,
     [__NR_mknod]        = sys_mknod,
@@ -46,6 +48,9 @@ static void *syscalls[] =
     [__NR_tcsetpgrp]    = sys_tcsetpgrp,
     [__NR_getcwd]       = sys_getcwd,
     [__NR_sbrk]         = sys_sbrk,
+    [__NR_mmap]         = sys_mmap,
+    [__NR_munmap]       = sys_munmap,
+    [__NR_mprotect]     = sys_mprotect,
     [__NR_nanosleep]    = sys_nanosleep,
     [__NR_fstat]        = sys_fstat,
     [__NR_sigaction]    = sys_sigaction,
@@ -56,7 +61,13 @@ static void *syscalls[] =
     [__NR_pipe]         = sys_pipe,
     [__NR_chdir]        = sys_chdir,
     [__NR_alarm]        = sys_alarm,
+    [__NR_getpriority]  = sys_getpriority,
+    [__NR_setpriority]  = sys_setpriority,
+    [__NR_sched_getparam] = sys_sched_getparam,
+    [__NR_sched_setscheduler] = sys_sched_setscheduler,
+    [__NR_sched_getscheduler] = sys_sched_getscheduler,
     [__NR_info]         = sys_info,
+    [__NR_kmemstat]     = sys_kmemstat,
 };
 
 #define SYSCALLS_NUM    (sizeof(syscalls)/sizeof(*syscalls))
@@ -72,6 +83,9 @@ static void syscall_handler(void)
 {
     struct isr_frame *ifr = current_task->arch.ifr;
 
+    /* The system calls may read the ticks counter */
+    timer_nohz_exit();
+
     if (ifr->eax < SYSCALLS_NUM && syscalls[ifr->eax])
     {
         ifr->eax = ((syscall_f)syscalls[ifr->eax])(
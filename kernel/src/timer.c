@@ -19,26 +19,113 @@
 
 #include "timer.h"
 #include "proc.h"
+#include "kprintf.h"
 
 unsigned long timer_ticks = 0;
 
 unsigned long timer_freq;
 
-/* Timer events queue. */
-static struct list_link timer_events;
+/* Timer interrupts taken and periodic ticks skipped by the one-shot mode */
+static unsigned long ticks_taken;
+static unsigned long ticks_skipped;
 
-void timer_event_add(struct timer_event *tm)
+/*
+ * Hierarchical timer wheel.
+ * The root level has a slot for each of the next TVR_SIZE ticks, each
+ * further level slot spans a whole turn of the previous level. A timer
+ * is hashed on the level matching its distance from the wheel clock, so
+ * insertion and removal are constant time. When the root level wraps, the
+ * next slot of the upper levels is cascaded down by reinsertion: each
+ * timer moves at most once per level.
+ */
+#define TVR_BITS    8
+#define TVN_BITS    6
+#define TVR_SIZE    (1 << TVR_BITS)
+#define TVN_SIZE    (1 << TVN_BITS)
+#define TVR_MASK    (TVR_SIZE - 1)
+#define TVN_MASK    (TVN_SIZE - 1)
+#define TVN_LEVELS  4
+
+/* Slot index of the upper level n for the given time */
+#define TVN_INDEX(time, n) \
+    (((time) >> (TVR_BITS + (n) * TVN_BITS)) & TVN_MASK)
+
+static struct timer_wheel {
+    unsigned long       clock;      /* Next tick to process */
+    struct list_link    tvr[TVR_SIZE];
+    struct list_link    tvn[TVN_LEVELS][TVN_SIZE];
+} wheel;
+
+static void wheel_insert(struct timer_event *tm)
 {
-    struct timer_event *e;
-    struct list_link *curr = timer_events.next;
-    while (curr != &timer_events)
-    {
-        e = list_container(curr, struct timer_event, link);
-        if (e->expires > tm->expires)
+    unsigned long expires = tm->expires;
+    unsigned long delta = expires - wheel.clock;
+    struct list_link *slot;
+    int n;
+
+    if ((long)delta < 0) {
+        /* Already expired, fire at the next processed tick */
+        slot = &wheel.tvr[wheel.clock & TVR_MASK];
+    } else if (delta < TVR_SIZE) {
+        slot = &wheel.tvr[expires & TVR_MASK];
+    } else {
+        for (n = 0; n < TVN_LEVELS - 1; n++) {
+            if (delta < (1UL << (TVR_BITS + (n + 1) * TVN_BITS)))
+                break;
+        }
+        slot = &wheel.tvn[n][TVN_INDEX(expires, n)];
+    }
+    list_insert_before(slot, &tm->link);
+}
+
+/* Move the timers of an upper level slot down, returns the slot index */
+static int wheel_cascade(int n)
+{
+    int i = TVN_INDEX(wheel.clock, n);
+    struct list_link *slot = &wheel.tvn[n][i];
+    struct list_link *curr;
+
+    while (!list_empty(slot)) {
+        curr = slot->next;
+        list_delete(curr);
+        wheel_insert(list_container(curr, struct timer_event, link));
+    }
+    return i;
+}
+
+/*
+ * Ticks to the first tick with some work, at most 'max'. The upper levels
+ * cascade when the root level wraps, thus that tick counts as busy.
+ */
+static unsigned long wheel_next(unsigned long max)
+{
+    unsigned long ticks, clock;
+
+    for (ticks = 1; ticks < max; ticks++) {
+        clock = wheel.clock + ticks - 1;
+        if ((clock & TVR_MASK) == 0 ||
+            !list_empty(&wheel.tvr[clock & TVR_MASK]))
             break;
-        curr = curr->next;
     }
-    list_insert_before(curr, &tm->link);
+    return ticks;
+}
+
+void timer_nohz_enter(void)
+{
+    timer_arch_oneshot(wheel_next(TVR_SIZE));
+}
+
+void timer_nohz_exit(void)
+{
+    unsigned long elapsed = timer_arch_oneshot_stop();
+
+    timer_ticks += elapsed;
+    ticks_skipped += elapsed;
+}
+
+void timer_event_add(struct timer_event *tm)
+{
+    wheel_insert(tm);
 }
 
 void timer_event_del(struct timer_event *tm)
@@ -48,8 +135,9 @@ void timer_event_del(struct timer_event *tm)
 
 void timer_event_mod(struct timer_event *tm, unsigned long expires)
 {
+    list_delete(&tm->link);
     tm->expires = expires;
-    timer_event_add(tm);
+    wheel_insert(tm);
 }
 
 void timer_event_init(struct timer_event *tm, timer_event_t *fn,
@@ -65,27 +153,62 @@ void timer_event_init(struct timer_event *tm, timer_event_t *fn,
 void timer_update(void)
 {
     struct timer_event *tm;
-    struct list_link *curr = timer_events.next;
-
-    while (curr != &timer_events)
-    {
-        tm = list_container(curr, struct timer_event, link);
-        curr = curr->next;
-        if (tm->expires <= timer_ticks)
-        {
+    struct list_link expired;
+    struct list_link *slot;
+    unsigned long ticks;
+    int i, n;
+
+    ticks = timer_arch_ticks();
+    timer_ticks += ticks;
+    ticks_taken++;
+    ticks_skipped += ticks - 1;
+
+    while ((long)(timer_ticks - wheel.clock) >= 0) {
+        i = wheel.clock & TVR_MASK;
+        /* Root level wrap, refill it from the upper levels */
+        for (n = 0; i == 0 && n < TVN_LEVELS; n++) {
+            if (wheel_cascade(n) != 0)
+                break;
+        }
+        wheel.clock++;
+
+        /* Detach the slot, the handlers may add new timers */
+        slot = &wheel.tvr[i];
+        if (list_empty(slot))
+            continue;
+        list_init(&expired);
+        list_merge(&expired, slot);
+        list_delete(slot);
+        while (!list_empty(&expired)) {
+            tm = list_container(expired.next, struct timer_event, link);
             list_delete(&tm->link);
             tm->func(tm->data);
         }
     }
 
-    extern int need_resched;
-    if (current_task->counter-- <= 0)
-        need_resched = 1;
+    sched_tick();
+
+    /* Nobody to preempt, wait for the next timer event */
+    if (!need_resched && sched_nohz_allowed())
+        timer_nohz_enter();
+}
+
+void timer_dump(void)
+{
+    kprintf("ticks: %lu, taken: %lu, skipped: %lu\n",
+            timer_ticks, ticks_taken, ticks_skipped);
 }
 
 void timer_init(unsigned int frequency)
 {
+    int i, n;
+
     timer_freq = frequency;
-    list_init(&timer_events);
+    wheel.clock = timer_ticks;
+    for (i = 0; i < TVR_SIZE; i++)
+        list_init(&wheel.tvr[i]);
+    for (n = 0; n < TVN_LEVELS; n++)
+        for (i = 0; i < TVN_SIZE; i++)
+            list_init(&wheel.tvn[n][i]);
     timer_arch_init(frequency);
 }
@@ -50,7 +50,7 @@ typedef void (timer_event_t)(void *data);
 /** Timer event structure. Represents an asynchrounous event. */
 struct timer_event
 {
-    struct list_link link;      /**< Link used when in the global queue. */
+    struct list_link link;      /**< Link used when in the timer wheel. */
     struct list_link plink;     /**< Link for timers within the same process */
     timer_event_t    *func;     /**< Timer event function callback. */
     void             *data;     /**< User context data. */
@@ -85,10 +85,10 @@ void timer_event_add(struct timer_event *tm);
 void timer_event_del(struct timer_event *tm);
 
 /**
- * Adds a timer queue to the timers queue.
- * This function also specifies the expration time in ticks.
+ * Sets the expiration time of a timer event and (re)adds it to the timers
+ * queue, a pending event is moved.
  * If the expration time is less than or equal the current 'timer_ticks' 
- * value the event is immediatelly executed.
+ * value the event is executed at the next tick.
  *
  * @param tm        Timer event structure.
  * @param expires   Event expiration time, in system ticks.
@@ -109,6 +109,33 @@ void timer_init(unsigned int frequency);
  */
 void timer_arch_init(unsigned int freq);
 
+/**
+ * Program the next timer interrupt in one-shot mode, on a tick boundary.
+ *
+ * @param ticks     Ticks to the interrupt.
+ * @return          Programmed ticks, limited by the hardware range. Zero if
+ *                  the timer is already in one-shot mode or if the interval
+ *                  is shorter than two ticks.
+ */
+unsigned long timer_arch_oneshot(unsigned long ticks);
+
+/**
+ * Shorten the pending one-shot interval to the next tick boundary, where
+ * the periodic mode is restored.
+ *
+ * @return          Ticks elapsed since the one-shot programming.
+ */
+unsigned long timer_arch_oneshot_stop(void);
+
+/**
+ * Ticks accounted by the current timer interrupt.
+ * One for a periodic tick, the whole interval at the end of a one-shot
+ * one, in which case the periodic mode is restored.
+ *
+ * @return          Elapsed ticks.
+ */
+unsigned long timer_arch_ticks(void);
+
 /**
  * Timer wheel update. 
  *
@@ -116,5 +143,24 @@ void timer_arch_init(unsigned int freq);
  */
 void timer_update(void);
 
+/**
+ * Stop the periodic tick up to the next timer event (tickless mode).
+ * Called when there is nobody to preempt: the idle task or a single task
+ * is runnable.
+ */
+void timer_nohz_enter(void);
+
+/**
+ * Restore the periodic tick and bring 'timer_ticks' up to date.
+ * Must be called before reading the ticks counter outside the timer
+ * interrupt and whenever a task becomes runnable.
+ */
+void timer_nohz_exit(void);
+
+/**
+ * Print the ticks taken and skipped by the tickless mode.
+ */
+void timer_dump(void);
+
 #endif /* _BEEOS_TIMER_H_ */
 
@@ -61,6 +61,17 @@ static inline unsigned int fnzb(unsigned long v)
     return n;
 }
 
+/**
+ * First non zero bit position starting from right.
+ * @param v     Value under analysis.
+ * @return      Zero based bit position.
+ *              If the input value is zero then returns 0.
+ */
+static inline unsigned int lnzb(unsigned long v)
+{
+    return fnzb(v & -v);
+}
+
 static inline int overlaps(uintptr_t b1, size_t sz1, uintptr_t b2, size_t sz2)
 {
     uintptr_t e1 = b1 + sz1;
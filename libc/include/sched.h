@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#ifndef _SCHED_H_
+#define _SCHED_H_
+
+#include <sys/types.h>
+#include <unistd.h>
+
+/* Scheduling policies */
+#define SCHED_OTHER     0   /**< Fair time sharing */
+#define SCHED_FIFO      1   /**< Real-time, runs until it blocks */
+#define SCHED_RR        2   /**< Real-time, round robin time slices */
+
+/** Scheduling parameters. */
+struct sched_param
+{
+    int sched_priority;     /**< Real-time priority, zero for SCHED_OTHER */
+};
+
+/**
+ * Set the scheduling policy and parameters of a process.
+ * Real-time policies always preempt SCHED_OTHER processes and require
+ * superuser privileges.
+ *
+ * @param pid       Process ID, zero for the caller.
+ * @param policy    Scheduling policy (e.g. SCHED_FIFO).
+ * @param param     Scheduling parameters.
+ * @return          Zero on success, -1 on error.
+ */
+static inline int sched_setscheduler(pid_t pid, int policy,
+        const struct sched_param *param)
+{
+    return syscall(__NR_sched_setscheduler, pid, policy, param);
+}
+
+/**
+ * Get the scheduling policy of a process.
+ *
+ * @param pid       Process ID, zero for the caller.
+ * @return          Scheduling policy, -1 on error.
+ */
+static inline int sched_getscheduler(pid_t pid)
+{
+    return syscall(__NR_sched_getscheduler, pid);
+}
+
+/**
+ * Get the scheduling parameters of a process.
+ *
+ * @param pid       Process ID, zero for the caller.
+ * @param param     Scheduling parameters buffer.
+ * @return          Zero on success, -1 on error.
+ */
+static inline int sched_getparam(pid_t pid, struct sched_param *param)
+{
+    return syscall(__NR_sched_getparam, pid, param);
+}
+
+/**
+ * Highest priority of a scheduling policy.
+ *
+ * @param policy    Scheduling policy.
+ * @return          Maximum priority, -1 on invalid policy.
+ */
+static inline int sched_get_priority_max(int policy)
+{
+    if (policy == SCHED_FIFO || policy == SCHED_RR)
+        return 32;
+    return (policy == SCHED_OTHER) ? 0 : -1;
+}
+
+/**
+ * Lowest priority of a scheduling policy.
+ *
+ * @param policy    Scheduling policy.
+ * @return          Minimum priority, -1 on invalid policy.
+ */
+static inline int sched_get_priority_min(int policy)
+{
+    if (policy == SCHED_FIFO || policy == SCHED_RR)
+        return 1;
+    return (policy == SCHED_OTHER) ? 0 : -1;
+}
+
+#endif /* _SCHED_H_ */
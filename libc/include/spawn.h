@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#ifndef _SPAWN_H_
+#define _SPAWN_H_
+
+#include <sys/types.h>
+#include <signal.h>
+
+/* Values for the spawn attributes flags */
+#define POSIX_SPAWN_SETPGROUP   0x01    /**< Set the process group */
+#define POSIX_SPAWN_SETSIGDEF   0x02    /**< Default action for sigdefault */
+#define POSIX_SPAWN_SETSIGMASK  0x04    /**< Set the signal mask */
+
+/** Spawn attributes. */
+typedef struct
+{
+    short       flags;          /**< Attributes to apply. */
+    pid_t       pgroup;         /**< Process group, 0 for a new group. */
+    sigset_t    sigdefault;     /**< Signals reset to the default action. */
+    sigset_t    sigmask;        /**< Signal mask. */
+} posix_spawnattr_t;
+
+/** Spawn file actions. Not supported, always pass a NULL pointer. */
+typedef struct
+{
+    int         unused;
+} posix_spawn_file_actions_t;
+
+/**
+ * Create a process executing a program.
+ * The new process image is loaded directly, the caller address space is
+ * never duplicated. File actions are not supported.
+ *
+ * @param pid       Where the child pid is stored (may be NULL).
+ * @param path      Executable file path.
+ * @param actions   File actions, must be NULL.
+ * @param attr      Spawn attributes (may be NULL).
+ * @param argv      Program arguments.
+ * @param envp      Program environment.
+ * @return          Zero on success, an error number on failure.
+ */
+int posix_spawn(pid_t *pid, const char *path,
+        const posix_spawn_file_actions_t *actions,
+        const posix_spawnattr_t *attr,
+        char *const argv[], char *const envp[]);
+
+static inline int posix_spawnattr_init(posix_spawnattr_t *attr)
+{
+    attr->flags = 0;
+    attr->pgroup = 0;
+    (void)sigemptyset(&attr->sigdefault);
+    (void)sigemptyset(&attr->sigmask);
+    return 0;
+}
+
+static inline int posix_spawnattr_destroy(posix_spawnattr_t *attr)
+{
+    (void)attr;
+    return 0;
+}
+
+static inline int posix_spawnattr_setflags(posix_spawnattr_t *attr,
+        short flags)
+{
+    attr->flags = flags;
+    return 0;
+}
+
+static inline int posix_spawnattr_setpgroup(posix_spawnattr_t *attr,
+        pid_t pgroup)
+{
+    attr->pgroup = pgroup;
+    return 0;
+}
+
+static inline int posix_spawnattr_setsigdefault(posix_spawnattr_t *attr,
+        const sigset_t *sigdefault)
+{
+    attr->sigdefault = *sigdefault;
+    return 0;
+}
+
+static inline int posix_spawnattr_setsigmask(posix_spawnattr_t *attr,
+        const sigset_t *sigmask)
+{
+    attr->sigmask = *sigmask;
+    return 0;
+}
+
+#endif /* _SPAWN_H_ */
@@ -92,8 +92,8 @@ int putenv(char *str);
 /**
  * The system() function passes the string pointed by 'cmd' to the host
  * environment to be executed by the command processor.
- * The function uses fork() to create a child process that executes
- * the shell command specified in 'cmd' using execl() as follows:
+ * The function uses posix_spawn() to create a child process that executes
+ * the shell command specified in 'cmd' as follows:
  *      execl("/bin/sh", "sh", "-c", command, (char *)0);
  * The function returns after the command has been completed.
  * During the execution of the command, SIGCHLD will be blocked, and
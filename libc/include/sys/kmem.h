@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+/*
+ * Kernel memory statistics (BeeOS specific).
+ */
+
+#ifndef _SYS_KMEM_H_
+#define _SYS_KMEM_H_
+
+#include <sys/types.h>
+#include <unistd.h>
+
+/* Values for the 'what' argument of kmemstat */
+#define KMEM_CACHES     0   /**< Slab caches, struct kmem_cache_stat */
+#define KMEM_ZONES      1   /**< Physical memory zones, struct kmem_zone_stat */
+
+#define KMEM_NAME_MAX   24  /**< Cache name length, including the null */
+#define KMEM_ORDER_MAX  16  /**< Buddy orders reported for each zone */
+
+/** Slab cache counters snapshot */
+struct kmem_cache_stat
+{
+    char            name[KMEM_NAME_MAX];    /**< Cache name */
+    size_t          objsize;    /**< Object size (slot size) */
+    size_t          inuse;      /**< Objects currently allocated */
+    unsigned int    slab_objs;  /**< Objects per slab */
+    unsigned int    slabs_full; /**< Slabs with all the objects in use */
+    unsigned int    slabs_part; /**< Slabs with some objects in use */
+    unsigned int    slabs_free; /**< Empty slabs retained by the cache */
+    unsigned long   allocs;     /**< Successful allocations */
+    unsigned long   frees;      /**< Released objects */
+    unsigned long   failed;     /**< Failed allocations */
+    size_t          wasted;     /**< Bytes wasted to rounding */
+};
+
+/** Physical memory zone counters snapshot */
+struct kmem_zone_stat
+{
+    int             flags;      /**< Zone type (0 high, 1 low memory) */
+    size_t          frame_size; /**< Frame size in bytes */
+    size_t          frames;     /**< Frames handled by the zone */
+    size_t          free;       /**< Free frames */
+    unsigned int    orders;     /**< Valid entries of free_blocks */
+    unsigned int    free_blocks[KMEM_ORDER_MAX]; /**< Free blocks per order */
+};
+
+/**
+ * Get a snapshot of the kernel memory allocators.
+ *
+ * @param what  Type of records to get (KMEM_CACHES or KMEM_ZONES).
+ * @param buf   Records buffer.
+ * @param size  Buffer size in bytes.
+ * @return      Number of records stored in the buffer, -1 on error.
+ */
+static inline int kmemstat(int what, void *buf, size_t size)
+{
+    return syscall(__NR_kmemstat, what, buf, size);
+}
+
+#endif /* _SYS_KMEM_H_ */
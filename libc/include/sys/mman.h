@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#ifndef _SYS_MMAN_H_
+#define _SYS_MMAN_H_
+
+#include <sys/types.h>
+#include <unistd.h>
+
+/* Values for the 'prot' argument of mmap and mprotect */
+#define PROT_NONE       0x00    /**< Pages can't be accessed */
+#define PROT_READ       0x01    /**< Pages can be read */
+#define PROT_WRITE      0x02    /**< Pages can be written */
+#define PROT_EXEC       0x04    /**< Pages can be executed */
+
+/* Values for the 'flags' argument of mmap */
+#define MAP_SHARED      0x01    /**< Share changes */
+#define MAP_PRIVATE     0x02    /**< Changes are private */
+#define MAP_FIXED       0x10    /**< Interpret addr exactly */
+#define MAP_ANONYMOUS   0x20    /**< Zero filled, not backed by a file */
+#define MAP_ANON        MAP_ANONYMOUS
+#define MAP_LARGE       0x100   /**< Use large pages if possible (BeeOS) */
+
+/** Value returned by mmap on failure */
+#define MAP_FAILED      ((void *)-1)
+
+/**
+ * Map files or anonymous memory.
+ * Writeable shared file mappings are not supported.
+ *
+ * @param addr      Mapping address, used only with MAP_FIXED.
+ * @param length    Mapping length.
+ * @param prot      Pages protection (e.g. PROT_READ).
+ * @param flags     Mapping flags (e.g. MAP_PRIVATE).
+ * @param fd        File descriptor, ignored for anonymous mappings.
+ * @param offset    File offset (page aligned).
+ * @return          Mapping address, MAP_FAILED on error.
+ */
+static inline void *mmap(void *addr, size_t length, int prot, int flags,
+        int fd, off_t offset)
+{
+    return (void *)syscall(__NR_mmap, addr, length, prot, flags, fd,
+            offset);
+}
+
+/**
+ * Remove the mappings of an address range.
+ *
+ * @param addr      Range address (page aligned).
+ * @param length    Range length.
+ * @return          Zero on success, -1 on error.
+ */
+static inline int munmap(void *addr, size_t length)
+{
+    return syscall(__NR_munmap, addr, length);
+}
+
+/**
+ * Set the protection of an address range.
+ *
+ * @param addr      Range address (page aligned).
+ * @param length    Range length.
+ * @param prot      Pages protection (e.g. PROT_READ).
+ * @return          Zero on success, -1 on error.
+ */
+static inline int mprotect(void *addr, size_t length, int prot)
+{
+    return syscall(__NR_mprotect, addr, length, prot);
+}
+
+#endif /* _SYS_MMAN_H_ */
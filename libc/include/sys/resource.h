@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#ifndef _SYS_RESOURCE_H_
+#define _SYS_RESOURCE_H_
+
+#include <sys/types.h>
+#include <unistd.h>
+
+/* Values for the 'which' argument of getpriority and setpriority */
+#define PRIO_PROCESS    0   /**< 'who' is a process ID */
+#define PRIO_PGRP       1   /**< 'who' is a process group ID */
+#define PRIO_USER       2   /**< 'who' is a user ID */
+
+/**
+ * Get the nice value of a process, process group or user.
+ * For groups and users the lowest nice value is returned.
+ *
+ * @param which     Kind of the 'who' argument (e.g. PRIO_PROCESS).
+ * @param who       Target ID, zero for the caller.
+ * @return          Nice value, -1 with errno set on error. Since -1 is
+ *                  a valid nice value, errno must be cleared before.
+ */
+static inline int getpriority(int which, id_t who)
+{
+    /* The kernel returns 20 - nice to avoid negative values */
+    int ret = syscall(__NR_getpriority, which, who);
+    return (ret < 0) ? -1 : 20 - ret;
+}
+
+/**
+ * Set the nice value of a process, process group or user.
+ * The value is clamped to the [-20, 19] range. Lowering the nice value
+ * requires superuser privileges.
+ *
+ * @param which     Kind of the 'who' argument (e.g. PRIO_PROCESS).
+ * @param who       Target ID, zero for the caller.
+ * @param prio      New nice value.
+ * @return          Zero on success, -1 on error.
+ */
+static inline int setpriority(int which, id_t who, int prio)
+{
+    return syscall(__NR_setpriority, which, who, prio);
+}
+
+#endif /* _SYS_RESOURCE_H_ */
@@ -61,7 +61,18 @@
 #define __NR_pipe           38
 #define __NR_chdir          39
 #define __NR_alarm          40
+#define __NR_mmap           90
+#define __NR_munmap         91
+#define __NR_getpriority    96
+#define __NR_setpriority    97
+#define __NR_mprotect       125
+#define __NR_sched_getparam 155
+#define __NR_sched_setscheduler 156
+#define __NR_sched_getscheduler 157
+#define __NR_vfork          190
+#define __NR_spawn          191
 #define __NR_info           99
+#define __NR_kmemstat       100
 
 #define STDIN_FILENO        0
 #define STDOUT_FILENO       1
@@ -98,6 +109,15 @@ static inline pid_t fork(void)
     return syscall(__NR_fork);
 }
 
+/**
+ * Create a child process sharing the caller memory.
+ * The caller is suspended until the child calls execve or _exit, the
+ * child must not return from the calling function nor modify any data.
+ *
+ * @return  Child pid in the parent, zero in the child, -1 on error.
+ */
+pid_t vfork(void);
+
 static inline ssize_t read(int fd, void *buf, size_t count)
 {
     return syscall(__NR_read, fd, buf, count);
@@ -241,6 +261,14 @@ int access(const char *path, int amode);
 
 int pause(void);
 
+/**
+ * Change the calling process nice value.
+ *
+ * @param inc   Increment, a negative one requires superuser privileges.
+ * @return      New nice value, -1 with errno set on error.
+ */
+int nice(int inc);
+
 static inline unsigned int alarm(unsigned int seconds)
 {
     return syscall(__NR_alarm, seconds);
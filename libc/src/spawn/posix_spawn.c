@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include <spawn.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stddef.h>
+
+int posix_spawn(pid_t *pid, const char *path,
+        const posix_spawn_file_actions_t *actions,
+        const posix_spawnattr_t *attr,
+        char *const argv[], char *const envp[])
+{
+    pid_t child;
+
+    if (actions != NULL)
+        return ENOSYS;
+    child = syscall(__NR_spawn, path, argv, envp, attr);
+    if (child < 0)
+        return errno;
+    if (pid != NULL)
+        *pid = child;
+    return 0;
+}
@@ -0,0 +1 @@
+local_sources := posix_spawn.c
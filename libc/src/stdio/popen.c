@@ -35,6 +35,7 @@ FILE *popen(const char *command, const char *type)
     int     pfd[2];
     pid_t   pid;
     FILE    *fp;
+    char    *argv[] = { "sh", "-c", (char *)command, NULL };
 
     /* only allow "r" or "w" */
     if ((type[0] != 'r' && type[0] != 'w') || type[1] != 0)
@@ -53,8 +54,12 @@ FILE *popen(const char *command, const char *type)
     if (pipe(pfd) < 0)
         return NULL;    /* errno set by pipe() */
 
-    if ((pid = fork()) < 0)
-        return NULL;    /* errno set by fork() */
+    /*
+     * The child only redirects its descriptors and execs, thus the caller
+     * memory is not duplicated (vfork).
+     */
+    if ((pid = vfork()) < 0)
+        return NULL;    /* errno set by vfork() */
     else if (pid == 0)
     {
         /* child */
@@ -82,7 +87,7 @@ FILE *popen(const char *command, const char *type)
             if (popen_childs[i] > 0)
                 close(i);
 
-        execl("/bin/sh", "sh", "-c", command, NULL);
+        execve("/bin/sh", argv, environ);
         _exit(127);
     }
 
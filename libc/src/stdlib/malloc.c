@@ -24,6 +24,7 @@
 #include <unistd.h>
 #include <errno.h>
 #include <string.h>
+#include <sys/mman.h>
 
 static struct malloc_head base;            /* empty list to get started */
 static struct malloc_head *freep = NULL;   /* start of free list */
@@ -36,11 +37,41 @@ static struct malloc_head *freep = NULL;   /* start of free list */
 
 #define NALLOC  (1024*ALIGN)
 
+/*
+ * Big blocks are mapped on their own, outside of the program break heap,
+ * and are returned to the system as soon as they are freed.
+ * The size of these blocks is tagged with the MMAPPED bit.
+ */
+#define MMAP_THRESHOLD  (128*1024)
+#define MMAP_PAGE       4096
+#define MMAPPED         1
+
+static void *mmap_alloc(size_t size)
+{
+    struct malloc_head *p;
+
+    size = (size + MMAP_PAGE - 1) & ~(MMAP_PAGE - 1);
+    p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+            -1, 0);
+    if (p == MAP_FAILED)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+    p->size = size | MMAPPED;
+    return TO_DATA(p);
+}
+
 
 void free(void *ptr)
 {
     struct malloc_head *curr, *prev;
     curr = TO_HEAD(ptr);
+    if (curr->size & MMAPPED)
+    {
+        munmap(curr, curr->size & ~MMAPPED);
+        return;
+    }
     for (prev = freep; !(prev < curr && curr < prev->next);
             prev = prev->next)
         if (prev >= prev->next &&
@@ -91,6 +122,8 @@ void *malloc(size_t size)
     
     /* size adjust */
     size = ALIGN_UP(size + sizeof(struct malloc_head));
+    if (size >= MMAP_THRESHOLD)
+        return mmap_alloc(size);
     
     if ((prev = freep) == NULL)
     {
@@ -136,7 +169,7 @@ void *realloc(void *ptr, size_t size)
         return new_ptr;
 
     head = TO_HEAD(ptr);
-    old_size = head->size - ((char *)ptr - (char *)head);
+    old_size = (head->size & ~MMAPPED) - ((char *)ptr - (char *)head);
     
     if (old_size < size)
         memcpy(new_ptr, ptr, old_size);
@@ -5,6 +5,7 @@ dirs += dirent \
 		string \
 		unistd \
 		signal \
+		spawn \
 		sys
 
 ifeq ($(ARCH),x86)
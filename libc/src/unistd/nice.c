@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include <unistd.h>
+#include <sys/resource.h>
+#include <errno.h>
+
+int nice(int inc)
+{
+    int prio;
+
+    errno = 0;
+    prio = getpriority(PRIO_PROCESS, 0);
+    if (prio == -1 && errno != 0)
+        return -1;
+    if (setpriority(PRIO_PROCESS, 0, prio + inc) < 0)
+    {
+        if (errno == EACCES)
+            errno = EPERM;
+        return -1;
+    }
+    return getpriority(PRIO_PROCESS, 0);
+}
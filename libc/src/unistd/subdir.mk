@@ -3,4 +3,5 @@ local_sources := environ.c \
 				 execlp.c \
 				 execvpe.c \
 				 access.c \
-				 pause.c
+				 pause.c \
+				 nice.c
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Helpers for the user space benchmark programs.
+ */
+
+#ifndef _LIBU_BENCH_H_
+#define _LIBU_BENCH_H_
+
+#include <stdint.h>
+#include <sys/types.h>
+
+/** Read the low 32 bits of the cpu time stamp counter. */
+static inline uint32_t rdtsc(void)
+{
+    uint32_t lo, hi;
+    asm volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+    return lo;
+}
+
+/** Benchmark integer argument. */
+struct bench_arg
+{
+    const char  *name;  /**< Name shown by the usage message */
+    int         *val;   /**< Value, initially holding the default */
+    int         min;    /**< Minimum valid value */
+};
+
+/**
+ * Parse the benchmark positional arguments.
+ * The usage message is printed on invalid arguments.
+ *
+ * @param argc      Arguments count, as passed to main.
+ * @param argv      Arguments vector, as passed to main.
+ * @param args      Arguments descriptors, in command line order.
+ * @param nargs     Number of descriptors.
+ * @return          Zero on success, -1 on invalid arguments.
+ */
+int bench_args(int argc, char *argv[], const struct bench_arg *args,
+        int nargs);
+
+/** Group of helper processes running alongside a benchmark. */
+struct bench_group
+{
+    pid_t   *pids;      /**< Children process IDs */
+    int     count;      /**< Started children */
+};
+
+/**
+ * Start a group of children.
+ * The fork failures are reported and end the group creation.
+ *
+ * @param group     Group descriptor.
+ * @param count     Number of children to start.
+ * @param func      Child body, the child exits if it returns.
+ * @param arg       Argument passed to the body with the child index.
+ * @return          Number of started children.
+ */
+int bench_group_start(struct bench_group *group, int count,
+        void (*func)(int idx, void *arg), void *arg);
+
+/**
+ * Kill and reap all the children of a group.
+ *
+ * @param group     Group descriptor.
+ */
+void bench_group_stop(struct bench_group *group);
+
+/** Child body sleeping until killed (see bench_group_start). */
+void bench_sleeper(int idx, void *arg);
+
+/** Child body spinning on the CPU until killed (see bench_group_start). */
+void bench_hog(int idx, void *arg);
+
+#endif /* _LIBU_BENCH_H_ */
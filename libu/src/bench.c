@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+
+int bench_args(int argc, char *argv[], const struct bench_arg *args,
+        int nargs)
+{
+    int i;
+
+    for (i = 0; i < nargs && i + 1 < argc; i++)
+        *args[i].val = atoi(argv[i + 1]);
+    for (i = 0; i < nargs; i++)
+    {
+        if (*args[i].val < args[i].min)
+            break;
+    }
+    if (argc > nargs + 1 || i < nargs)
+    {
+        printf("usage: %s", argv[0]);
+        for (i = 0; i < nargs; i++)
+            printf(" [%s]", args[i].name);
+        printf("\n");
+        return -1;
+    }
+    return 0;
+}
+
+int bench_group_start(struct bench_group *group, int count,
+        void (*func)(int idx, void *arg), void *arg)
+{
+    pid_t pid;
+
+    group->count = 0;
+    group->pids = malloc((count + 1) * sizeof(pid_t));
+    if (!group->pids)
+    {
+        perror("malloc");
+        return 0;
+    }
+    while (group->count < count)
+    {
+        pid = fork();
+        if (pid < 0)
+        {
+            perror("fork");
+            break;
+        }
+        if (pid == 0)
+        {
+            func(group->count, arg);
+            _exit(0);
+        }
+        group->pids[group->count++] = pid;
+    }
+    return group->count;
+}
+
+void bench_group_stop(struct bench_group *group)
+{
+    int i;
+
+    for (i = 0; i < group->count; i++)
+    {
+        kill(group->pids[i], SIGKILL);
+        waitpid(group->pids[i], NULL, 0);
+    }
+    free(group->pids);
+    group->pids = NULL;
+    group->count = 0;
+}
+
+void bench_sleeper(int idx, void *arg)
+{
+    for (;;)
+        pause();
+}
+
+void bench_hog(int idx, void *arg)
+{
+    for (;;)
+        ;
+}
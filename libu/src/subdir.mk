@@ -1,2 +1,3 @@
 local_sources := err.c \
-				 sig_wait_tell.c
+				 sig_wait_tell.c \
+				 bench.c
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+/*
+ * Kernel memory allocators statistics.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <sys/kmem.h>
+
+#define CACHES_MAX  64
+#define ZONES_MAX   4
+
+static struct kmem_cache_stat caches[CACHES_MAX];
+static struct kmem_zone_stat zones[ZONES_MAX];
+
+static void caches_dump(void)
+{
+    int i, n;
+    struct kmem_cache_stat *st;
+
+    n = kmemstat(KMEM_CACHES, caches, sizeof(caches));
+    if (n < 0)
+    {
+        printf("kmem: caches snapshot error\n");
+        return;
+    }
+    printf("%-20s %6s %6s %4s %4s %4s %8s %8s %4s %7s\n",
+           "cache", "size", "inuse", "full", "part", "free",
+           "allocs", "frees", "fail", "wasted");
+    for (i = 0; i < n; i++)
+    {
+        st = &caches[i];
+        printf("%-20s %6u %6u %4u %4u %4u %8u %8u %4u %7u\n",
+               st->name, st->objsize, st->inuse,
+               st->slabs_full, st->slabs_part, st->slabs_free,
+               (unsigned int)st->allocs, (unsigned int)st->frees,
+               (unsigned int)st->failed, st->wasted);
+    }
+}
+
+static void zones_dump(void)
+{
+    int i, n;
+    unsigned int j;
+    struct kmem_zone_stat *st;
+
+    n = kmemstat(KMEM_ZONES, zones, sizeof(zones));
+    if (n < 0)
+    {
+        printf("kmem: zones snapshot error\n");
+        return;
+    }
+    for (i = 0; i < n; i++)
+    {
+        st = &zones[i];
+        printf("zone %s: frames=%u, free=%u, free blocks per order:",
+               st->flags ? "low" : "high", st->frames, st->free);
+        for (j = 0; j < st->orders; j++)
+            printf(" %u", st->free_blocks[j]);
+        printf("\n");
+    }
+}
+
+static void usage(void)
+{
+    printf("kmem: usage [-c | -z]\n");
+    exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+    int show_caches = 1, show_zones = 1;
+
+    if (argc > 2)
+        usage();
+    if (argc == 2)
+    {
+        if (strcmp(argv[1], "-c") == 0)
+            show_zones = 0;
+        else if (strcmp(argv[1], "-z") == 0)
+            show_caches = 0;
+        else
+            usage();
+    }
+
+    if (show_caches)
+        caches_dump();
+    if (show_zones)
+        zones_dump();
+    return 0;
+}
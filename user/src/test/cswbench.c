@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Context switch benchmark.
+ * Two processes bounce a byte through a couple of pipes, each round trip
+ * costs two context switches. The measure is repeated after the creation
+ * of a crowd of sleeping processes: the switch cost must not depend on
+ * the number of tasks that are not runnable.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "bench.h"
+
+#define SLEEPERS_DEFAULT    200
+#define LOOPS_DEFAULT       1000
+
+static void pingpong(int sleepers, int loops)
+{
+    int p1[2], p2[2], i;
+    uint32_t t;
+    pid_t pid;
+    char c = 0;
+
+    if (pipe(p1) < 0 || pipe(p2) < 0)
+    {
+        perror("pipe");
+        return;
+    }
+    pid = fork();
+    if (pid < 0)
+    {
+        perror("fork");
+        return;
+    }
+    if (pid == 0)
+    {
+        close(p1[1]);
+        close(p2[0]);
+        while (read(p1[0], &c, 1) == 1)
+            write(p2[1], &c, 1);
+        _exit(0);
+    }
+    close(p1[0]);
+    close(p2[1]);
+
+    t = rdtsc();
+    for (i = 0; i < loops; i++)
+    {
+        write(p1[1], &c, 1);
+        read(p2[0], &c, 1);
+    }
+    t = rdtsc() - t;
+    printf("sleepers=%-4d loops=%d, avg=%u cycles/switch\n",
+           sleepers, loops, t / (2 * loops));
+
+    close(p1[1]);
+    close(p2[0]);
+    waitpid(pid, NULL, 0);
+}
+
+int main(int argc, char *argv[])
+{
+    int sleepers = SLEEPERS_DEFAULT;
+    int loops = LOOPS_DEFAULT;
+    struct bench_arg args[] = {
+        { "sleepers", &sleepers, 0 },
+        { "loops", &loops, 1 },
+    };
+    struct bench_group group;
+
+    if (bench_args(argc, argv, args, 2) < 0)
+        return 1;
+
+    pingpong(0, loops);
+    bench_group_start(&group, sleepers, bench_sleeper, NULL);
+    pingpong(group.count, loops);
+    bench_group_stop(&group);
+    return 0;
+}
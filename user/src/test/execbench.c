@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Exec benchmark.
+ * Measures the latency from execve to the first instructions of the new
+ * program (this program re-executed with the "-t" argument) and the total
+ * runtime of some of the system tools.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "bench.h"
+
+#define LOOPS_DEFAULT   20
+
+static char *tools[][3] = {
+    { "/bin/echo", "hello", NULL },
+    { "/bin/pwd", NULL, NULL },
+    { "/bin/ls", "/", NULL },
+    { "/bin/kmem", "-z", NULL },
+};
+
+static uint32_t parse(const char *str)
+{
+    uint32_t v = 0;
+
+    while (*str >= '0' && *str <= '9')
+        v = v * 10 + (*str++ - '0');
+    return v;
+}
+
+/*
+ * Run a program with the standard output redirected to a pipe.
+ * If 'out' is not NULL the program output is stored there.
+ * Returns the cycles elapsed from the fork to the program exit.
+ */
+static uint32_t run(char *argv[], char *out, size_t size)
+{
+    int fd[2];
+    pid_t pid;
+    uint32_t t;
+    char buf[64];
+    ssize_t n;
+    size_t len = 0;
+
+    if (pipe(fd) < 0)
+        return 0;
+    t = rdtsc();
+    pid = fork();
+    if (pid < 0)
+        return 0;
+    if (pid == 0)
+    {
+        close(fd[0]);
+        dup2(fd[1], STDOUT_FILENO);
+        close(fd[1]);
+        if (out != NULL)
+        {
+            /* Time stamp for the exec latency */
+            snprintf(buf, sizeof(buf), "%u", rdtsc());
+            argv[2] = buf;
+        }
+        execve(argv[0], argv, environ);
+        _exit(1);
+    }
+    close(fd[1]);
+    while ((n = read(fd[0], buf, sizeof(buf))) > 0)
+    {
+        if (out != NULL && len + n < size)
+        {
+            memcpy(out + len, buf, n);
+            len += n;
+        }
+    }
+    if (out != NULL)
+        out[len] = '\0';
+    close(fd[0]);
+    waitpid(pid, NULL, 0);
+    return rdtsc() - t;
+}
+
+static void bench_exec(char *path, int loops)
+{
+    char *argv[] = { path, "-t", NULL, NULL };
+    char out[16];
+    uint32_t dt, tot = 0, min = (uint32_t)-1, max = 0;
+    int i;
+
+    for (i = 0; i < loops; i++)
+    {
+        run(argv, out, sizeof(out));
+        dt = parse(out);
+        tot += dt;
+        if (min > dt)
+            min = dt;
+        if (max < dt)
+            max = dt;
+    }
+    printf("%-12s loops=%d, avg=%u, min=%u, max=%u cycles\n",
+           "exec-start", loops, tot / loops, min, max);
+}
+
+static void bench_tool(char *argv[], int loops)
+{
+    uint32_t tot = 0;
+    int i;
+
+    for (i = 0; i < loops; i++)
+        tot += run(argv, NULL, 0);
+    printf("%-12s loops=%d, avg=%u cycles\n", argv[0], loops, tot / loops);
+}
+
+int main(int argc, char *argv[])
+{
+    int loops = LOOPS_DEFAULT;
+    struct bench_arg args[] = {
+        { "loops", &loops, 1 },
+    };
+    unsigned int i;
+
+    if (argc > 2 && strcmp(argv[1], "-t") == 0)
+    {
+        printf("%u", rdtsc() - parse(argv[2]));
+        return 0;
+    }
+    if (bench_args(argc, argv, args, 1) < 0)
+        return 1;
+    bench_exec(argv[0], loops);
+    for (i = 0; i < sizeof(tools) / sizeof(tools[0]); i++)
+        bench_tool(tools[i], loops);
+    return 0;
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Fork and exec latency benchmark.
+ * Each iteration forks a child that immediately exits or that re-executes
+ * this program (which exits as soon as it sees the "-x" argument).
+ * Optionally the parent first dirties a heap buffer, to measure how the
+ * fork cost scales with the process size.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "bench.h"
+
+#define LOOPS_DEFAULT   100
+
+static void bench(const char *name, char *path, int loops)
+{
+    char *argv[] = { path, "-x", NULL };
+    uint32_t t, dt, tot = 0, min = (uint32_t)-1, max = 0;
+    pid_t pid;
+    int i;
+
+    for (i = 0; i < loops; i++)
+    {
+        t = rdtsc();
+        pid = fork();
+        if (pid < 0)
+        {
+            printf("fork error\n");
+            return;
+        }
+        if (pid == 0)
+        {
+            if (path != NULL)
+                execve(path, argv, environ);
+            _exit(0);
+        }
+        waitpid(pid, NULL, 0);
+        dt = rdtsc() - t;
+        tot += dt;
+        if (min > dt)
+            min = dt;
+        if (max < dt)
+            max = dt;
+    }
+    printf("%-10s loops=%d, avg=%u, min=%u, max=%u cycles\n",
+           name, loops, tot / loops, min, max);
+}
+
+int main(int argc, char *argv[])
+{
+    int loops = LOOPS_DEFAULT;
+    int kbytes = 0;
+    struct bench_arg args[] = {
+        { "loops", &loops, 1 },
+        { "heap kbytes", &kbytes, 0 },
+    };
+    char *heap;
+
+    if (argc > 1 && strcmp(argv[1], "-x") == 0)
+        return 0;
+    if (bench_args(argc, argv, args, 2) < 0)
+        return 1;
+    if (kbytes > 0)
+    {
+        heap = malloc(kbytes * 1024);
+        if (heap == NULL)
+        {
+            printf("malloc error\n");
+            return 1;
+        }
+        memset(heap, 1, kbytes * 1024);
+    }
+    bench("fork+exit", NULL, loops);
+    bench("fork+exec", argv[0], loops);
+    return 0;
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Kernel heap benchmark.
+ * Keeps alive a crowd of sleeping processes, each one with its own page
+ * directory, and then measures some kernel heap intensive operations:
+ * pipes creation (pipe buffers and files) and short lived processes
+ * (task structures, page directories and page tables).
+ * Kernel page tables are shared by all the page directories, thus the
+ * cost must not depend on the number of processes.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "bench.h"
+
+#define PROCS_DEFAULT   100
+#define LOOPS_DEFAULT   200
+
+static void bench_pipe(int loops)
+{
+    int fd[2];
+    uint32_t t;
+    int i;
+
+    t = rdtsc();
+    for (i = 0; i < loops; i++)
+    {
+        if (pipe(fd) < 0)
+        {
+            perror("pipe");
+            return;
+        }
+        close(fd[0]);
+        close(fd[1]);
+    }
+    t = rdtsc() - t;
+    printf("%-6s loops=%d, avg=%u cycles\n", "pipe", loops, t / loops);
+}
+
+static void bench_fork(int loops)
+{
+    pid_t pid;
+    uint32_t t;
+    int i;
+
+    t = rdtsc();
+    for (i = 0; i < loops; i++)
+    {
+        pid = fork();
+        if (pid < 0)
+        {
+            perror("fork");
+            return;
+        }
+        if (pid == 0)
+            _exit(0);
+        waitpid(pid, NULL, 0);
+    }
+    t = rdtsc() - t;
+    printf("%-6s loops=%d, avg=%u cycles\n", "fork", loops, t / loops);
+}
+
+int main(int argc, char *argv[])
+{
+    int procs = PROCS_DEFAULT;
+    int loops = LOOPS_DEFAULT;
+    struct bench_arg args[] = {
+        { "procs", &procs, 0 },
+        { "loops", &loops, 1 },
+    };
+    struct bench_group sleepers;
+
+    if (bench_args(argc, argv, args, 2) < 0)
+        return 1;
+
+    bench_group_start(&sleepers, procs, bench_sleeper, NULL);
+    printf("%d sleeping processes\n", sleepers.count);
+    bench_pipe(loops);
+    bench_fork(loops);
+    bench_group_stop(&sleepers);
+    return 0;
+}
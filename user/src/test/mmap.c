@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Memory mappings test.
+ * Maps anonymous memory, a file (by default /bin/sh) and checks that
+ * the file mapping content matches the data read from the file. Then
+ * checks the rejection of the unsupported shared mappings and finally
+ * that a write to a page made read only by mprotect raises SIGSEGV.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#define ANON_SIZE   (256 * 1024)
+
+static void handler(int signo)
+{
+    printf("mprotect: write SIGSEGV\n");
+    exit(0);
+}
+
+static int test_anon(void)
+{
+    char *p;
+    int i;
+
+    p = mmap(NULL, ANON_SIZE, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+    {
+        perror("mmap");
+        return -1;
+    }
+    for (i = 0; i < ANON_SIZE; i += 4096)
+    {
+        if (p[i] != 0)
+        {
+            printf("anon: page not zero filled\n");
+            return -1;
+        }
+        p[i] = i >> 12;
+    }
+    for (i = 0; i < ANON_SIZE; i += 4096)
+    {
+        if (p[i] != (char)(i >> 12))
+        {
+            printf("anon: bad content\n");
+            return -1;
+        }
+    }
+    printf("anon: %d KB at %p\n", ANON_SIZE / 1024, p);
+    return munmap(p, ANON_SIZE);
+}
+
+static int test_file(const char *path)
+{
+    struct stat st;
+    char buf[512], *p;
+    ssize_t n, i;
+    off_t off = 0;
+    int fd;
+
+    if ((fd = open(path, O_RDONLY, 0)) < 0 || fstat(fd, &st) < 0)
+    {
+        perror(path);
+        return -1;
+    }
+    p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED)
+    {
+        perror("mmap");
+        close(fd);
+        return -1;
+    }
+    while ((n = read(fd, buf, sizeof(buf))) > 0)
+    {
+        for (i = 0; i < n && p[off] == buf[i]; i++)
+            off++;
+        if (i < n)
+        {
+            printf("file: content mismatch at %d\n", (int)off);
+            break;
+        }
+    }
+    close(fd);
+    munmap(p, st.st_size);
+    if (off != st.st_size)
+        return -1;
+    printf("file: %s, %d bytes\n", path, (int)off);
+    return 0;
+}
+
+static int test_shared(const char *path)
+{
+    char *p;
+    int fd, res;
+
+    p = mmap(NULL, 4096, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (p != MAP_FAILED || errno != EINVAL)
+    {
+        printf("shared: anonymous mapping not rejected\n");
+        return -1;
+    }
+    if ((fd = open(path, O_RDONLY, 0)) < 0)
+    {
+        perror(path);
+        return -1;
+    }
+    p = mmap(NULL, 4096, PROT_READ, MAP_SHARED | MAP_PRIVATE, fd, 0);
+    if (p != MAP_FAILED || errno != EINVAL)
+    {
+        printf("shared: shared and private mapping not rejected\n");
+        close(fd);
+        return -1;
+    }
+    p = mmap(NULL, 4096, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED)
+    {
+        perror("mmap");
+        return -1;
+    }
+    res = mprotect(p, 4096, PROT_READ | PROT_WRITE);
+    munmap(p, 4096);
+    if (res == 0 || errno != EACCES)
+    {
+        printf("shared: write permission not rejected\n");
+        return -1;
+    }
+    printf("shared: unsupported mappings rejected\n");
+    return 0;
+}
+
+static int test_malloc(void)
+{
+    char *p, *q;
+
+    p = malloc(1024 * 1024);
+    if (p == NULL)
+    {
+        printf("malloc: no memory\n");
+        return -1;
+    }
+    memset(p, 1, 1024 * 1024);
+    free(p);
+    q = malloc(1024 * 1024);
+    printf("malloc: 1 MB at %p, again at %p\n", p, q);
+    free(q);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *path = (argc > 1) ? argv[1] : "/bin/sh";
+    char *p;
+
+    if (test_anon() < 0 || test_file(path) < 0 || test_shared(path) < 0 ||
+        test_malloc() < 0)
+        return 1;
+
+    p = mmap(NULL, 4096, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+        return 1;
+    p[0] = 1;
+    mprotect(p, 4096, PROT_READ);
+    printf("mprotect: read %d\n", p[0]);
+    signal(SIGSEGV, handler);
+    p[0] = 2;
+    printf("mprotect: no SIGSEGV\n");
+    return 1;
+}
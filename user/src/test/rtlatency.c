@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Real-time wakeup latency histogram.
+ * A process sleeps for one clock tick at a time while CPU bound hogs
+ * compete for the processor, first as a SCHED_OTHER process and then as
+ * a SCHED_FIFO one. The sleeps always expire on a tick, thus the time
+ * elapsed past the tick grid is the wakeup latency. The tick period is
+ * calibrated on the idle system. Requires superuser privileges for the
+ * real-time run.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include <sched.h>
+#include "bench.h"
+
+#define HOGS_DEFAULT    4
+#define LOOPS_DEFAULT   200
+#define PRIO_DEFAULT    16
+#define SLEEP_USECS     10000   /* One tick at 100 Hz */
+#define BUCKETS         10      /* Histogram buckets per tick */
+
+/* Average duration of a one tick sleep on the idle system */
+static uint32_t calibrate(int loops)
+{
+    uint32_t t, sum = 0;
+    int i;
+
+    usleep(SLEEP_USECS);    /* Align to the tick */
+    for (i = 0; i < loops; i++)
+    {
+        t = rdtsc();
+        usleep(SLEEP_USECS);
+        sum += (rdtsc() - t) / loops;
+    }
+    return sum;
+}
+
+static void histogram(const char *name, uint32_t period, int loops)
+{
+    unsigned int hist[BUCKETS + 1] = { 0 };
+    uint32_t t, prev, phase = 0, lat;
+    int i;
+
+    usleep(SLEEP_USECS);
+    prev = rdtsc();
+    for (i = 0; i < loops; i++)
+    {
+        usleep(SLEEP_USECS);
+        t = rdtsc();
+        /* Previous latency plus this sleep, one period plus the latency */
+        phase += t - prev;
+        prev = t;
+        lat = (phase > period) ? phase - period : 0;
+        if (lat >= period)
+            hist[BUCKETS]++;
+        else
+            hist[lat * BUCKETS / period]++;
+        phase = lat % period;
+    }
+
+    printf("%s:\n", name);
+    for (i = 0; i < BUCKETS; i++)
+        printf("  < %2d/%d tick  %u\n", i + 1, BUCKETS, hist[i]);
+    printf("  >= 1 tick     %u\n", hist[BUCKETS]);
+}
+
+int main(int argc, char *argv[])
+{
+    int hogs = HOGS_DEFAULT;
+    int loops = LOOPS_DEFAULT;
+    int prio = PRIO_DEFAULT;
+    struct bench_arg args[] = {
+        { "hogs", &hogs, 0 },
+        { "loops", &loops, 1 },
+        { "prio", &prio, 1 },
+    };
+    struct sched_param param;
+    struct bench_group group;
+    uint32_t period;
+
+    if (bench_args(argc, argv, args, 3) < 0)
+        return 1;
+
+    period = calibrate(loops);
+    printf("tick=%u cycles, hogs=%d, loops=%d\n", period, hogs, loops);
+
+    bench_group_start(&group, hogs, bench_hog, NULL);
+    histogram("SCHED_OTHER", period, loops);
+    param.sched_priority = prio;
+    if (sched_setscheduler(0, SCHED_FIFO, &param) < 0)
+        perror("sched_setscheduler");
+    else
+        histogram("SCHED_FIFO", period, loops);
+    bench_group_stop(&group);
+    return 0;
+}
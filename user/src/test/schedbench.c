@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Scheduler wakeup latency benchmark.
+ * An interactive process repeatedly sleeps for a tick and measures how long
+ * it takes to get back the CPU, first on an idle system and then competing
+ * with a number of CPU bound batch processes. A fair scheduler credits the
+ * sleeper, thus its latency must stay close to the idle system one.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include "bench.h"
+
+#define HOGS_DEFAULT    4
+#define LOOPS_DEFAULT   100
+#define SLEEP_USECS     10000
+
+static void latency(int hogs, int loops)
+{
+    uint32_t t, sum = 0, max = 0;
+    int i;
+
+    for (i = 0; i < loops; i++)
+    {
+        t = rdtsc();
+        usleep(SLEEP_USECS);
+        t = rdtsc() - t;
+        sum += t / loops;
+        if (t > max)
+            max = t;
+    }
+    printf("hogs=%-3d loops=%d, sleep avg=%u max=%u cycles\n",
+           hogs, loops, sum, max);
+}
+
+/* CPU bound batch process, eventually niced */
+static void hog(int idx, void *arg)
+{
+    int inc = *(int *)arg;
+
+    if (inc != 0 && nice(inc) < 0)
+        perror("nice");
+    bench_hog(idx, arg);
+}
+
+int main(int argc, char *argv[])
+{
+    int hogs = HOGS_DEFAULT;
+    int loops = LOOPS_DEFAULT;
+    int inc = 0;
+    struct bench_arg args[] = {
+        { "hogs", &hogs, 0 },
+        { "loops", &loops, 1 },
+        { "nice", &inc, -20 },
+    };
+    struct bench_group group;
+
+    if (bench_args(argc, argv, args, 3) < 0)
+        return 1;
+
+    latency(0, loops);
+    bench_group_start(&group, hogs, hog, &inc);
+    latency(group.count, loops);
+    bench_group_stop(&group);
+    return 0;
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define STACK_DEPTH     64      /* Recursion levels, 1K of stack each */
+
+static void handler(int signo)
+{
+    printf("SIGSEGV handler\n");
+    exit(0);
+}
+
+static int recurse(int n)
+{
+    volatile char buf[1024];
+
+    buf[0] = n;
+    return (n == 0) ? buf[0] : recurse(n - 1) + buf[0];
+}
+
+int main(void)
+{
+    char *heap;
+
+    /* Stack grows on demand */
+    recurse(STACK_DEPTH);
+    printf("stack grown by %d KB\n", STACK_DEPTH);
+
+    /* Heap pages are mapped on first touch */
+    heap = sbrk(64 * 1024);
+    heap[0] = 1;
+    heap[64 * 1024 - 1] = 1;
+    printf("heap touched\n");
+
+    /* Syscall buffer outside any memory area */
+    if (write(STDOUT_FILENO, (void *)16, 1) != -1 || errno != EFAULT)
+    {
+        printf("write: no EFAULT\n");
+        return 1;
+    }
+    printf("write: EFAULT\n");
+
+    /* Access outside any memory area */
+    signal(SIGSEGV, handler);
+    *(volatile char *)NULL = 1;
+    printf("no SIGSEGV\n");
+    return 1;
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Process creation benchmark.
+ * Measures the average cost of fork+exec, vfork+exec and posix_spawn of
+ * a program that immediately exits (this program with the "-x" argument),
+ * waiting for each child termination. The parent memory is first grown
+ * by the given size, the fork copy cost depends on it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include "bench.h"
+
+#define LOOPS_DEFAULT   50
+#define SIZE_DEFAULT    1024    /* KB */
+
+static char *self;
+
+static pid_t run_fork(char *argv[])
+{
+    pid_t pid;
+
+    pid = fork();
+    if (pid == 0)
+    {
+        execve(self, argv, environ);
+        _exit(127);
+    }
+    return pid;
+}
+
+static pid_t run_vfork(char *argv[])
+{
+    pid_t pid;
+
+    pid = vfork();
+    if (pid == 0)
+    {
+        execve(self, argv, environ);
+        _exit(127);
+    }
+    return pid;
+}
+
+static pid_t run_spawn(char *argv[])
+{
+    pid_t pid;
+
+    if (posix_spawn(&pid, self, NULL, NULL, argv, environ) != 0)
+        return -1;
+    return pid;
+}
+
+static void bench(const char *name, pid_t (*run)(char **), int loops)
+{
+    char *argv[] = { self, "-x", NULL };
+    uint32_t t;
+    int i, status;
+    pid_t pid;
+
+    t = rdtsc();
+    for (i = 0; i < loops; i++)
+    {
+        pid = run(argv);
+        if (pid < 0)
+        {
+            perror(name);
+            return;
+        }
+        waitpid(pid, &status, 0);
+    }
+    t = rdtsc() - t;
+    printf("%-8s loops=%d, avg=%u cycles\n", name, loops, t / loops);
+}
+
+int main(int argc, char *argv[])
+{
+    int loops = LOOPS_DEFAULT;
+    int size = SIZE_DEFAULT;
+    struct bench_arg args[] = {
+        { "loops", &loops, 1 },
+        { "KB", &size, 0 },
+    };
+    char *mem;
+
+    if (argc > 1 && strcmp(argv[1], "-x") == 0)
+        return 0;
+    if (bench_args(argc, argv, args, 2) < 0)
+        return 1;
+    self = argv[0];
+
+    /* Touched memory, duplicated by fork */
+    mem = malloc(size << 10);
+    if (mem == NULL && size != 0)
+    {
+        perror("malloc");
+        return 1;
+    }
+    memset(mem, 1, size << 10);
+
+    printf("parent memory %d KB\n", size);
+    bench("fork", run_fork, loops);
+    bench("vfork", run_vfork, loops);
+    bench("spawn", run_spawn, loops);
+    free(mem);
+    return 0;
+}
@@ -14,6 +14,17 @@ local_sources := dump.c \
 				 divbyzero.c \
 				 serial.c \
 				 initadopt.c \
-				 pgrp.c
+				 pgrp.c \
+				 forkexec.c \
+				 segv.c \
+				 execbench.c \
+				 mmap.c \
+				 tlbbench.c \
+				 kheapbench.c \
+				 spawnbench.c \
+				 cswbench.c \
+				 schedbench.c \
+				 rtlatency.c \
+				 timerbench.c
 
 dirs := cp03 cp08
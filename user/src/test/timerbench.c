@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * Timer queue benchmark.
+ * Measures the cost of re-arming an alarm and the CPU time left to a busy
+ * loop, first on an idle system and then with a crowd of processes each
+ * holding a pending alarm or nanosleep timer. With a timer wheel both the
+ * insertion and the per tick expiry check must not depend on the number
+ * of pending timers.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+#include "bench.h"
+
+#define TIMERS_DEFAULT  1000
+#define LOOPS_DEFAULT   1000
+#define WORK_LOOPS      20000000
+#define TIMEOUT_MIN     60      /* Seconds, never expire during the test */
+
+static void measure(int timers, int loops)
+{
+    uint32_t t, arm;
+    volatile int i;
+
+    t = rdtsc();
+    for (i = 0; i < loops; i++)
+        alarm(TIMEOUT_MIN + i % TIMEOUT_MIN);
+    arm = (rdtsc() - t) / loops;
+    alarm(0);
+
+    t = rdtsc();
+    for (i = 0; i < WORK_LOOPS; i++)
+        ;
+    t = rdtsc() - t;
+
+    printf("timers=%-5d alarm=%u cycles, busy loop=%u cycles\n",
+           timers, arm, t);
+}
+
+/* Arms a timer, half alarms and half sleeps, then tells the parent */
+static void sleeper(int idx, void *arg)
+{
+    int fd = *(int *)arg;
+    char c = 0;
+
+    if (idx % 2 == 0)
+    {
+        alarm(TIMEOUT_MIN + idx % TIMEOUT_MIN);
+        write(fd, &c, 1);
+        pause();
+    }
+    else
+    {
+        write(fd, &c, 1);
+        sleep(TIMEOUT_MIN + idx % TIMEOUT_MIN);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int timers = TIMERS_DEFAULT;
+    int loops = LOOPS_DEFAULT;
+    struct bench_arg args[] = {
+        { "timers", &timers, 0 },
+        { "loops", &loops, 1 },
+    };
+    struct bench_group group;
+    int fd[2], i;
+    char c;
+
+    if (bench_args(argc, argv, args, 2) < 0)
+        return 1;
+    if (pipe(fd) < 0)
+    {
+        perror("pipe");
+        return 1;
+    }
+
+    measure(0, loops);
+
+    bench_group_start(&group, timers, sleeper, &fd[1]);
+    close(fd[1]);
+    for (i = 0; i < group.count; i++)
+        read(fd[0], &c, 1);
+    close(fd[0]);
+
+    measure(group.count, loops);
+    bench_group_stop(&group);
+    return 0;
+}
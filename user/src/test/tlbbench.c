@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2015-2017, Davide Galassi. All rights reserved.
+ *
+ * This file is part of the BeeOS software.
+ *
+ * BeeOS is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with BeeOS; if not, see <http://www.gnu/licenses/>.
+ */
+
+/*
+ * TLB stress benchmark.
+ * Walks a big anonymous buffer touching one word per page, first mapped
+ * with small pages and then with large pages (MAP_LARGE). With small pages
+ * each access needs its own TLB entry, with large pages a single entry
+ * covers 4 MB. The first touch (populate) cost is reported as well.
+ * Large pages are available only if there are free 4 MB aligned frames,
+ * otherwise small pages are silently used (e.g. run qemu with -m 32).
+ */
+
+#include <stdio.h>
+#include <sys/mman.h>
+#include "bench.h"
+
+#define SIZE_DEFAULT    8       /* MB */
+#define LOOPS_DEFAULT   16
+#define STRIDE          4096
+
+static void bench(const char *name, size_t size, int loops, int flags)
+{
+    volatile char *p;
+    uint32_t t, populate, walk;
+    size_t off;
+    int i, sum = 0;
+
+    p = mmap(NULL, size, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0);
+    if (p == MAP_FAILED)
+    {
+        perror("mmap");
+        return;
+    }
+
+    t = rdtsc();
+    for (off = 0; off < size; off += STRIDE)
+        p[off] = 1;
+    populate = rdtsc() - t;
+
+    t = rdtsc();
+    for (i = 0; i < loops; i++)
+        for (off = 0; off < size; off += STRIDE)
+            sum += p[off];
+    walk = rdtsc() - t;
+
+    printf("%-6s populate=%u cycles, walk=%u cycles/page (sum %d)\n",
+           name, populate, walk / (loops * (size / STRIDE)), sum);
+    munmap((void *)p, size);
+}
+
+int main(int argc, char *argv[])
+{
+    int mbytes = SIZE_DEFAULT;
+    int loops = LOOPS_DEFAULT;
+    struct bench_arg args[] = {
+        { "MB", &mbytes, 1 },
+        { "loops", &loops, 1 },
+    };
+    size_t size;
+
+    if (bench_args(argc, argv, args, 2) < 0)
+        return 1;
+    size = (size_t)mbytes << 20;
+
+    printf("buffer %u MB, %d loops\n", size >> 20, loops);
+    bench("small", size, loops, 0);
+    bench("large", size, loops, MAP_LARGE);
+    return 0;
+}